@@ -191,7 +191,7 @@ int main(int argc, char *argv[])
     g_palette = &palette;
 
     VMainWindow w(&guard);
-    QString style = palette.fetchQtStyleSheet();
+    QString style = palette.fetchQtStyleSheet(g_config->getStyleCacheFolder());
     if (!style.isEmpty()) {
         app.setStyleSheet(style);
     }
@@ -7,7 +7,7 @@ marked.setOptions({
             if (hljs.getLanguage(lang)) {
                 return hljs.highlight(lang, code).value;
             } else {
-                return hljs.highlightAuto(code).value;
+                return highlightCodeAuto(code);
             }
         } else {
             return code;
@@ -17,6 +17,7 @@ marked.setOptions({
 
 var updateHtml = function(html) {
     placeholder.innerHTML = html;
+    resetLazyRendering();
 
     insertImageCaption();
 
@@ -52,17 +53,7 @@ var updateHtml = function(html) {
 
     // If you add new logics after handling MathJax, please pay attention to
     // finishLoading logic.
-    // MathJax may be not loaded for now.
-    if (VEnableMathjax && (typeof MathJax != "undefined")) {
-        try {
-            MathJax.Hub.Queue(["Typeset", MathJax.Hub, placeholder, finishLogics]);
-        } catch (err) {
-            content.setLog("err: " + err);
-            finishLogics();
-        }
-    } else {
-        finishLogics();
-    }
+    renderMathJax(placeholder, finishLogics);
 };
 
 var highlightText = function(text, id, timeStamp) {
@@ -48,7 +48,7 @@ var mdit = window.markdownit({
             if (hljs.getLanguage(lang)) {
                 return hljs.highlight(lang, str).value;
             } else {
-                return hljs.highlightAuto(str).value;
+                return highlightCodeAuto(str);
             }
         } else {
             // Use external default escaping.
@@ -80,6 +80,23 @@ mdit = mdit.use(window.markdownitSup);
 */
 mdit = mdit.use(window.markdownitFootnote);
 
+// Tag top-level blocks with the source line they start at, which is used to
+// sync the scroll position with the editor at any line.
+// Only for the preview, which renders with env.sourceLine set.
+mdit.core.ruler.push('source_line', function(state) {
+    if (!state.env || !state.env.sourceLine) {
+        return;
+    }
+
+    var tokens = state.tokens;
+    for (var i = 0; i < tokens.length; ++i) {
+        var token = tokens[i];
+        if (token.map && token.level == 0 && token.nesting >= 0 && token.block) {
+            token.attrSet('data-source-line', String(token.map[0]));
+        }
+    }
+});
+
 var mdHasTocSection = function(markdown) {
     var n = markdown.search(/(\n|^)\[toc\]/i);
     return n != -1;
@@ -88,7 +105,7 @@ var mdHasTocSection = function(markdown) {
 var markdownToHtml = function(markdown, needToc) {
     toc = [];
     nameCounter = 0;
-    var html = mdit.render(markdown);
+    var html = mdit.render(markdown, { sourceLine: true });
     if (needToc) {
         return html.replace(/<p>\[TOC\]<\/p>/ig, '<div class="vnote-toc"></div>');
     } else {
@@ -96,10 +113,120 @@ var markdownToHtml = function(markdown, needToc) {
     }
 };
 
+// Render notes larger than this progressively in chunks.
+var ProgressiveRenderingThreshold = 200 * 1024;
+
+// Number of top-level blocks in the first chunk, which should fill the first
+// screen, and in the following chunks.
+var ProgressiveFirstChunkBlocks = 50;
+var ProgressiveChunkBlocks = 200;
+
+// Increased on each update to cancel pending chunks of last update.
+var renderGeneration = 0;
+
+// Split @tokens into ranges [start, end) of top-level blocks.
+var splitTokensToChunks = function(tokens) {
+    var chunks = [];
+    var start = 0;
+    var blocks = 0;
+    var limit = ProgressiveFirstChunkBlocks;
+    for (var i = 0; i < tokens.length; ++i) {
+        // A top-level block ends at a closing or self-contained token.
+        if (tokens[i].level == 0 && tokens[i].nesting != 1) {
+            if (++blocks >= limit) {
+                chunks.push([start, i + 1]);
+                start = i + 1;
+                blocks = 0;
+                limit = ProgressiveChunkBlocks;
+            }
+        }
+    }
+
+    if (start < tokens.length) {
+        chunks.push([start, tokens.length]);
+    }
+
+    return chunks;
+};
+
+// Render @text chunk by chunk when idle, handling each chunk once it is
+// inserted so that the first screen shows up as soon as possible.
+var updateTextProgressively = function(text) {
+    var generation = renderGeneration;
+    var needToc = mdHasTocSection(text);
+
+    toc = [];
+    nameCounter = 0;
+    var env = { sourceLine: true };
+    var tokens = mdit.parse(text, env);
+    var chunks = splitTokensToChunks(tokens);
+
+    placeholder.innerHTML = '';
+    resetLazyRendering();
+    mermaidIdx = 0;
+    flowchartIdx = 0;
+    renderCodeBlockLineNumber();
+
+    var renderChunk = function(idx) {
+        if (generation != renderGeneration) {
+            return;
+        }
+
+        var html = mdit.renderer.render(tokens.slice(chunks[idx][0], chunks[idx][1]),
+                                        mdit.options,
+                                        env);
+        if (needToc) {
+            html = html.replace(/<p>\[TOC\]<\/p>/ig, '<div class="vnote-toc"></div>');
+        }
+
+        // Handle the chunk in a wrapper and then unwrap it.
+        var wrapper = document.createElement('div');
+        placeholder.appendChild(wrapper);
+        wrapper.innerHTML = html;
+
+        insertImageCaption(wrapper);
+        renderMermaid('lang-mermaid', wrapper);
+        renderFlowchart('lang-flowchart', wrapper);
+        addClassToCodeBlock(wrapper);
+        renderCodeBlockLineNumber(wrapper);
+
+        while (wrapper.firstChild) {
+            placeholder.insertBefore(wrapper.firstChild, wrapper);
+        }
+
+        placeholder.removeChild(wrapper);
+        invalidateHeaders(false);
+
+        if (idx + 1 < chunks.length) {
+            runWhenIdle(function() {
+                renderChunk(idx + 1);
+            });
+        } else {
+            handleToc(needToc);
+            finishUpdateText();
+        }
+    };
+
+    renderChunk(0);
+};
+
+var finishUpdateText = function() {
+    // If you add new logics after handling MathJax, please pay attention to
+    // finishLoading logic.
+    renderMathJax(placeholder, finishLogics);
+};
+
 var updateText = function(text) {
+    ++renderGeneration;
+    if (VLazyRendering && text.length >= ProgressiveRenderingThreshold) {
+        updateTextProgressively(text);
+        return;
+    }
+
     var needToc = mdHasTocSection(text);
     var html = markdownToHtml(text, needToc);
     placeholder.innerHTML = html;
+    resetLazyRendering();
     handleToc(needToc);
     insertImageCaption();
     renderMermaid('lang-mermaid');
@@ -107,18 +234,7 @@ var updateText = function(text) {
     addClassToCodeBlock();
     renderCodeBlockLineNumber();
 
-    // If you add new logics after handling MathJax, please pay attention to
-    // finishLoading logic.
-    if (VEnableMathjax) {
-        try {
-            MathJax.Hub.Queue(["Typeset", MathJax.Hub, placeholder, finishLogics]);
-        } catch (err) {
-            content.setLog("err: " + err);
-            finishLogics();
-        }
-    } else {
-        finishLogics();
-    }
+    finishUpdateText();
 };
 
 var highlightText = function(text, id, timeStamp) {
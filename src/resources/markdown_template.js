@@ -24,6 +24,15 @@ if (typeof VEnableMathjax == 'undefined') {
     VEnableMathjax = false;
 }
 
+// Used to invalidate the MathJax cache when MathJax changes.
+if (typeof VMathjaxCacheKey == 'undefined') {
+    VMathjaxCacheKey = '';
+}
+
+if (typeof VMathjaxCacheSize == 'undefined') {
+    VMathjaxCacheSize = 0;
+}
+
 if (typeof VEnableHighlightLineNumber == 'undefined') {
     VEnableHighlightLineNumber = false;
 }
@@ -32,6 +41,20 @@ if (typeof VStylesToInline == 'undefined') {
     VStylesToInline = '';
 }
 
+// Whether defer some rendering until the content is about to be visible.
+// Should be false when exporting.
+if (typeof VLazyRendering == 'undefined') {
+    VLazyRendering = false;
+}
+
+if (typeof VCodeBlockAutoDetectLanguages == 'undefined') {
+    VCodeBlockAutoDetectLanguages = '';
+}
+
+if (typeof VCodeBlockAutoDetectBudget == 'undefined') {
+    VCodeBlockAutoDetectBudget = 0;
+}
+
 // Add a caption (using alt text) under the image.
 var VImageCenterClass = 'img-center';
 var VImageCaptionClass = 'img-caption';
@@ -52,6 +75,7 @@ new QWebChannel(qt.webChannelTransport,
             content.updateText();
         }
         content.requestScrollToAnchor.connect(scrollToAnchor);
+        content.requestScrollToLine.connect(scrollToSourceLine);
 
         if (typeof highlightText == "function") {
             content.requestHighlightText.connect(highlightText);
@@ -80,12 +104,192 @@ var highlightAnchor = function(anchor) {
 
 var g_muteScroll = false;
 
+// Cached headers and their offsets in ascending order.
+// Rebuilt lazily after the content or the layout changes.
+var g_headers = null;
+var g_headerOffsets = [];
+
+// The anchor of the header last sent to content.
+var g_lastHeaderAnchor = null;
+
+// Cached source lines of elements with data-source-line and their offsets,
+// both in ascending order. Rebuilt lazily together with the headers.
+var g_sourceLines = null;
+var g_sourceLineOffsets = [];
+
+// @resetCurrent: whether the content has been updated.
+var invalidateHeaders = function(resetCurrent) {
+    g_headers = null;
+    g_headerOffsets = [];
+    g_sourceLines = null;
+    g_sourceLineOffsets = [];
+    if (resetCurrent) {
+        g_lastHeaderAnchor = null;
+    }
+};
+
+var fetchHeaders = function() {
+    if (!g_headers) {
+        g_headers = document.querySelectorAll("h1, h2, h3, h4, h5, h6");
+        g_headerOffsets = new Array(g_headers.length);
+        for (var i = 0; i < g_headers.length; ++i) {
+            g_headerOffsets[i] = g_headers[i].offsetTop;
+        }
+    }
+
+    return g_headers;
+};
+
+// Return the index of the last header at or above @offset, or -1.
+var headerIndexAtOffset = function(offset) {
+    fetchHeaders();
+
+    return lastIndexNotGreater(g_headerOffsets, offset);
+};
+
+var fetchSourceLines = function() {
+    if (!g_sourceLines) {
+        var eles = document.querySelectorAll("[data-source-line]");
+        g_sourceLines = [];
+        g_sourceLineOffsets = [];
+        for (var i = 0; i < eles.length; ++i) {
+            var line = parseInt(eles[i].getAttribute("data-source-line"));
+            // Skip nested ones out of order.
+            if (g_sourceLines.length > 0
+                && line <= g_sourceLines[g_sourceLines.length - 1]) {
+                continue;
+            }
+
+            g_sourceLines.push(line);
+            g_sourceLineOffsets.push(eles[i].offsetTop);
+        }
+    }
+
+    return g_sourceLines;
+};
+
+// Return the index of the last item in ascending @arr not greater than @val, or -1.
+var lastIndexNotGreater = function(arr, val) {
+    var lo = 0;
+    var hi = arr.length - 1;
+    var idx = -1;
+    while (lo <= hi) {
+        var mid = (lo + hi) >> 1;
+        if (arr[mid] <= val) {
+            idx = mid;
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+
+    return idx;
+};
+
+// Map between source line and offset by interpolating within the entry
+// @idx of table @from to table @to.
+var interpolateSourceLine = function(from, to, idx, val) {
+    if (idx == -1) {
+        return to.length > 0 ? to[0] : 0;
+    }
+
+    if (idx + 1 >= from.length || from[idx + 1] == from[idx]) {
+        return to[idx];
+    }
+
+    var ratio = (val - from[idx]) / (from[idx + 1] - from[idx]);
+    return to[idx] + ratio * (to[idx + 1] - to[idx]);
+};
+
+// Return the source line at the top of the viewport, or -1 if not supported.
+var sourceLineAtScrollTop = function() {
+    var lines = fetchSourceLines();
+    if (lines.length == 0) {
+        return -1;
+    }
+
+    var scrollTop = document.documentElement.scrollTop || document.body.scrollTop || window.pageYOffset;
+    var idx = lastIndexNotGreater(g_sourceLineOffsets, scrollTop);
+    return Math.floor(interpolateSourceLine(g_sourceLineOffsets, lines, idx, scrollTop));
+};
+
+// Scroll to make source line @line at the top of the viewport.
+var scrollToSourceLine = function(line) {
+    var lines = fetchSourceLines();
+    if (lines.length == 0 || line < 0) {
+        return;
+    }
+
+    var idx = lastIndexNotGreater(lines, line);
+    var offset = interpolateSourceLine(lines, g_sourceLineOffsets, idx, line);
+
+    g_muteScroll = true;
+    window.scrollTo(0, offset);
+
+    currentHeaderIdx = headerIndexAtOffset(offset + 50);
+    var curHeader = null;
+    if (currentHeaderIdx != -1) {
+        curHeader = g_headers[currentHeaderIdx].getAttribute("id");
+    }
+
+    setCurrentHeader(curHeader ? curHeader : "");
+    content.setSourceLine(line);
+    setTimeout("g_muteScroll = false", 100);
+};
+
+var sourceLineTimer = null;
+
+// Tell content the source line at the top now.
+// Should be called after scrolling with g_muteScroll set.
+var updateSourceLine = function() {
+    if (sourceLineTimer) {
+        clearTimeout(sourceLineTimer);
+        sourceLineTimer = null;
+    }
+
+    var line = sourceLineAtScrollTop();
+    if (line != -1) {
+        content.setSourceLine(line);
+    }
+};
+
+// Tell content the source line at the top once the scrolling stops.
+var updateSourceLineLater = function() {
+    if (sourceLineTimer) {
+        clearTimeout(sourceLineTimer);
+    }
+
+    sourceLineTimer = setTimeout(updateSourceLine, 200);
+};
+
+// Tell content the current header only if it changes.
+var setCurrentHeader = function(anchor) {
+    if (anchor === g_lastHeaderAnchor) {
+        return;
+    }
+
+    g_lastHeaderAnchor = anchor;
+    content.setHeader(anchor);
+};
+
+window.addEventListener('resize', function() {
+    invalidateHeaders(false);
+});
+
+// Loading of images will change the offsets of headers.
+document.addEventListener('load', function(e) {
+    if (e.target.tagName == 'IMG') {
+        invalidateHeaders(false);
+    }
+}, true);
+
 var scrollToAnchor = function(anchor) {
     g_muteScroll = true;
     currentHeaderIdx = -1;
     if (!anchor) {
         window.scrollTo(0, 0);
         g_muteScroll = false;
+        updateSourceLine();
         return;
     }
 
@@ -94,7 +298,7 @@ var scrollToAnchor = function(anchor) {
         anc.scrollIntoView();
         highlightAnchor(anc);
 
-        var headers = document.querySelectorAll("h1, h2, h3, h4, h5, h6");
+        var headers = fetchHeaders();
         for (var i = 0; i < headers.length; ++i) {
             if (headers[i] == anc) {
                 currentHeaderIdx = i;
@@ -103,6 +307,8 @@ var scrollToAnchor = function(anchor) {
         }
     }
 
+    updateSourceLine();
+
     // Disable scroll temporarily.
     setTimeout("g_muteScroll = false", 100);
 };
@@ -120,35 +326,108 @@ window.onscroll = function() {
         return;
     }
 
-    currentHeaderIdx = -1;
     var scrollTop = document.documentElement.scrollTop || document.body.scrollTop || window.pageYOffset;
-    var eles = document.querySelectorAll("h1, h2, h3, h4, h5, h6");
-
-    if (eles.length == 0) {
-        content.setHeader("");
-        return;
-    }
-
-    var biaScrollTop = scrollTop + 50;
-    for (var i = 0; i < eles.length; ++i) {
-        if (biaScrollTop >= eles[i].offsetTop) {
-            currentHeaderIdx = i;
-        } else {
-            break;
-        }
-    }
+    var eles = fetchHeaders();
+    currentHeaderIdx = headerIndexAtOffset(scrollTop + 50);
 
     var curHeader = null;
     if (currentHeaderIdx != -1) {
         curHeader = eles[currentHeaderIdx].getAttribute("id");
     }
 
-    content.setHeader(curHeader ? curHeader : "");
+    setCurrentHeader(curHeader ? curHeader : "");
+    updateSourceLineLater();
 };
 
 // Used to record the repeat token of user input.
 var repeatToken = 0;
 
+// Navigations requested by keys but not applied yet. They are coalesced and
+// applied once per animation frame, so holding a key will not pile up scrolls.
+// Each one is { type: 'scrollBy', dx, dy }, { type: 'scrollTo', top }, or
+// { type: 'jumpTitle', forward, relativeLevel, repeat }.
+var pendingNavigations = [];
+
+var navigationScheduled = false;
+
+var scheduleNavigations = function() {
+    if (navigationScheduled) {
+        return;
+    }
+
+    navigationScheduled = true;
+    window.requestAnimationFrame(applyNavigations);
+};
+
+var queueScrollBy = function(dx, dy) {
+    var last = pendingNavigations[pendingNavigations.length - 1];
+    if (last && last.type == 'scrollBy') {
+        last.dx += dx;
+        last.dy += dy;
+    } else {
+        pendingNavigations.push({ type: 'scrollBy', dx: dx, dy: dy });
+    }
+
+    scheduleNavigations();
+};
+
+var queueScrollTo = function(top) {
+    // Previous navigations make no difference.
+    pendingNavigations = [{ type: 'scrollTo', top: top }];
+    scheduleNavigations();
+};
+
+var queueJumpTitle = function(forward, relativeLevel, repeat) {
+    // Jumps to upper level could not be merged since the target level is
+    // decided by the header where each jump starts.
+    var last = pendingNavigations[pendingNavigations.length - 1];
+    if (last
+        && relativeLevel >= 0
+        && last.type == 'jumpTitle'
+        && last.forward == forward
+        && last.relativeLevel == relativeLevel) {
+        last.repeat += repeat;
+    } else {
+        pendingNavigations.push({ type: 'jumpTitle',
+                                  forward: forward,
+                                  relativeLevel: relativeLevel,
+                                  repeat: repeat });
+    }
+
+    scheduleNavigations();
+};
+
+var applyNavigations = function() {
+    navigationScheduled = false;
+    var navs = pendingNavigations;
+    pendingNavigations = [];
+    for (var i = 0; i < navs.length; ++i) {
+        var nav = navs[i];
+        switch (nav.type) {
+        case 'scrollBy':
+            window.scrollBy(nav.dx, nav.dy);
+            break;
+
+        case 'scrollTo':
+        {
+            var scrollLeft = document.documentElement.scrollLeft || document.body.scrollLeft || window.pageXOffset;
+            window.scrollTo(scrollLeft, nav.top);
+            break;
+        }
+
+        case 'jumpTitle':
+            if (i > 0) {
+                // onscroll has not updated the current header yet.
+                var scrollTop = document.documentElement.scrollTop || document.body.scrollTop || window.pageYOffset;
+                currentHeaderIdx = headerIndexAtOffset(scrollTop + 50);
+            }
+
+            jumpTitle(nav.forward, nav.relativeLevel, nav.repeat);
+            break;
+        }
+    }
+};
+
 document.onkeydown = function(e) {
     // Need to clear pending kyes.
     var clear = true;
@@ -212,7 +491,7 @@ document.onkeydown = function(e) {
 
     case 74: // J
         if (!ctrl && !shift) {
-            window.scrollBy(0, 100);
+            queueScrollBy(0, 100);
             break;
         }
 
@@ -221,7 +500,7 @@ document.onkeydown = function(e) {
 
     case 75: // K
         if (!ctrl && !shift) {
-            window.scrollBy(0, -100);
+            queueScrollBy(0, -100);
             break;
         }
 
@@ -230,7 +509,7 @@ document.onkeydown = function(e) {
 
     case 72: // H
         if (!ctrl && !shift) {
-            window.scrollBy(-100, 0);
+            queueScrollBy(-100, 0);
             break;
         }
 
@@ -239,7 +518,7 @@ document.onkeydown = function(e) {
 
     case 76: // L
         if (!ctrl && !shift) {
-            window.scrollBy(100, 0);
+            queueScrollBy(100, 0);
             break;
         }
 
@@ -249,9 +528,8 @@ document.onkeydown = function(e) {
     case 71: // G
         if (shift) {
             if (pendingKeys.length == 0) {
-                var scrollLeft = document.documentElement.scrollLeft || document.body.scrollLeft || window.pageXOffset;
                 var scrollHeight = document.documentElement.scrollHeight || document.body.scrollHeight;
-                window.scrollTo(scrollLeft, scrollHeight);
+                queueScrollTo(scrollHeight);
                 break;
             }
         } else if (!ctrl) {
@@ -268,10 +546,7 @@ document.onkeydown = function(e) {
             } else if (pendingKeys.length == 1) {
                 var pendKey = pendingKeys[0];
                 if (pendKey.key == key && !pendKey.shift && !pendKey.ctrl) {
-                    var scrollLeft = document.documentElement.scrollLeft
-                                     || document.body.scrollLeft
-                                     || window.pageXOffset;
-                    window.scrollTo(scrollLeft, 0);
+                    queueScrollTo(0);
                     break;
                 }
             }
@@ -283,7 +558,7 @@ document.onkeydown = function(e) {
     case 85: // U
         if (ctrl) {
             var clientHeight = document.documentElement.clientHeight;
-            window.scrollBy(0, -clientHeight / 2);
+            queueScrollBy(0, -clientHeight / 2);
             break;
         }
 
@@ -293,7 +568,7 @@ document.onkeydown = function(e) {
     case 68: // D
         if (ctrl) {
             var clientHeight = document.documentElement.clientHeight;
-            window.scrollBy(0, clientHeight / 2);
+            queueScrollBy(0, clientHeight / 2);
             break;
         }
 
@@ -309,7 +584,7 @@ document.onkeydown = function(e) {
                 var pendKey = pendingKeys[0];
                 if (pendKey.key == key && !pendKey.shift && !pendKey.ctrl) {
                     // [{, jump to previous title at a higher level.
-                    jumpTitle(false, -1, repeat);
+                    queueJumpTitle(false, -1, repeat);
                     break;
                 }
             }
@@ -329,11 +604,11 @@ document.onkeydown = function(e) {
                 var pendKey = pendingKeys[0];
                 if (pendKey.key == key && !pendKey.shift && !pendKey.ctrl) {
                     // [[, jump to previous title.
-                    jumpTitle(false, 1, repeat);
+                    queueJumpTitle(false, 1, repeat);
                     break;
                 } else if (pendKey.key == 221 && !pendKey.shift && !pendKey.ctrl) {
                     // ][, jump to next title at the same level.
-                    jumpTitle(true, 0, repeat);
+                    queueJumpTitle(true, 0, repeat);
                     break;
                 }
             }
@@ -352,7 +627,7 @@ document.onkeydown = function(e) {
                 var pendKey = pendingKeys[0];
                 if (pendKey.key == key && !pendKey.shift && !pendKey.ctrl) {
                     // ]}, jump to next title at a higher level.
-                    jumpTitle(true, -1, repeat);
+                    queueJumpTitle(true, -1, repeat);
                     break;
                 }
             }
@@ -372,11 +647,11 @@ document.onkeydown = function(e) {
                 var pendKey = pendingKeys[0];
                 if (pendKey.key == key && !pendKey.shift && !pendKey.ctrl) {
                     // ]], jump to next title.
-                    jumpTitle(true, 1, repeat);
+                    queueJumpTitle(true, 1, repeat);
                     break;
                 } else if (pendKey.key == 219 && !pendKey.shift && !pendKey.ctrl) {
                     // [], jump to previous title at the same level.
-                    jumpTitle(false, 0, repeat);
+                    queueJumpTitle(false, 0, repeat);
                     break;
                 }
             }
@@ -403,6 +678,118 @@ document.onkeydown = function(e) {
     }
 };
 
+// Distance in px beyond the viewport to render the pending content.
+var LazyRenderingMargin = 500;
+
+// Height in px reserved for a diagram before it is rendered.
+var LazyDiagramReservedHeight = 300;
+
+// Pending tasks to render elements when they are about to be visible.
+// Each task is { ele, func } where func(done) renders ele and calls done().
+// Tasks are kept as a property of the element observed.
+var lazyRenderObserver = null;
+
+// Cancel pending lazy rendering of last update.
+// Renderers should call it once the content is replaced.
+var resetLazyRendering = function() {
+    if (lazyRenderObserver) {
+        lazyRenderObserver.disconnect();
+    }
+};
+
+var addLazyRenderTask = function(ele, func) {
+    if (!lazyRenderObserver) {
+        // The browser computes the intersections off the scroll handlers,
+        // so no layout is forced by reading the position of each element.
+        lazyRenderObserver = new IntersectionObserver(renderVisibleLazyTasks,
+                                                      { rootMargin: LazyRenderingMargin + 'px 0px' });
+    }
+
+    if (!ele.vnoteLazyTasks) {
+        ele.vnoteLazyTasks = [];
+        lazyRenderObserver.observe(ele);
+    }
+
+    ele.vnoteLazyTasks.push(func);
+};
+
+var renderVisibleLazyTasks = function(entries) {
+    // Collect all the visible tasks before any rendering changes the layout.
+    var tasks = [];
+    for (var i = 0; i < entries.length; ++i) {
+        var entry = entries[i];
+        var visible = entry.isIntersecting === undefined ? entry.intersectionRatio > 0
+                                                         : entry.isIntersecting;
+        if (!visible || !entry.target.vnoteLazyTasks) {
+            continue;
+        }
+
+        lazyRenderObserver.unobserve(entry.target);
+        var funcs = entry.target.vnoteLazyTasks;
+        entry.target.vnoteLazyTasks = null;
+        for (var j = 0; j < funcs.length; ++j) {
+            tasks.push({ ele: entry.target,
+                         func: funcs[j],
+                         height: entry.boundingClientRect.height });
+        }
+    }
+
+    for (var i = 0; i < tasks.length; ++i) {
+        var task = tasks[i];
+        task.func(makeLazyRenderDone(task.ele, task.height));
+    }
+};
+
+// Return a callback for a lazy rendering of @ele whose height was @oldHeight.
+// Keep the content in the viewport still if @ele above it changes its height.
+// The position is checked when the rendering is done, since it may finish
+// asynchronously after more scrolling.
+var makeLazyRenderDone = function(ele, oldHeight) {
+    return function() {
+        if (!document.body.contains(ele)) {
+            return;
+        }
+
+        var rect = ele.getBoundingClientRect();
+        var delta = rect.height - oldHeight;
+        // Whether @ele was above the viewport before the change.
+        if (rect.bottom - delta <= 0) {
+            if (delta != 0) {
+                g_muteScroll = true;
+                window.scrollBy(0, delta);
+                setTimeout("g_muteScroll = false", 100);
+            }
+        }
+
+        invalidateHeaders(false);
+        updateSourceLineLater();
+    };
+};
+
+// Class of diagram code blocks waiting to be rendered.
+var VLazyDiagramClass = 'lazy-diagram';
+
+// Render diagram @code via @func when it is about to be visible.
+var renderDiagramLazily = function(code, func) {
+    code.classList.add(VLazyDiagramClass);
+    var pre = code.parentNode;
+    pre.style.minHeight = LazyDiagramReservedHeight + 'px';
+    addLazyRenderTask(pre, function(done) {
+        try {
+            if (code.parentNode == pre) {
+                func(code);
+            }
+        } catch (err) {
+            content.setLog("err: " + err);
+        } finally {
+            // The code block may be kept as is if it fails to render.
+            code.classList.remove(VLazyDiagramClass);
+            pre.style.minHeight = '';
+            done();
+        }
+    });
+};
+
 var mermaidParserErr = false;
 var mermaidIdx = 0;
 
@@ -421,17 +808,24 @@ if (VEnableMermaid) {
 }
 
 // @className, the class name of the mermaid code block, such as 'lang-mermaid'.
-var renderMermaid = function(className) {
+// @root: only render code blocks within it if specified. The sequence of the
+// graphs will continue from last call.
+var renderMermaid = function(className, root) {
     if (!VEnableMermaid) {
         return;
     }
 
-    var codes = document.getElementsByTagName('code');
-    mermaidIdx = 0;
+    var codes = (root || document).getElementsByTagName('code');
+    if (!root) {
+        mermaidIdx = 0;
+    }
+
     for (var i = 0; i < codes.length; ++i) {
         var code = codes[i];
         if (code.classList.contains(className)) {
-            if (renderMermaidOne(code)) {
+            if (VLazyRendering) {
+                renderDiagramLazily(code, renderMermaidOne);
+            } else if (renderMermaidOne(code)) {
                 // replaceChild() will decrease codes.length.
                 --i;
             }
@@ -469,17 +863,24 @@ var renderMermaidOne = function(code) {
 var flowchartIdx = 0;
 
 // @className, the class name of the flowchart code block, such as 'lang-flowchart'.
-var renderFlowchart = function(className) {
+// @root: only render code blocks within it if specified. The sequence of the
+// graphs will continue from last call.
+var renderFlowchart = function(className, root) {
     if (!VEnableFlowchart) {
         return;
     }
 
-    var codes = document.getElementsByTagName('code');
-    flowchartIdx = 0;
+    var codes = (root || document).getElementsByTagName('code');
+    if (!root) {
+        flowchartIdx = 0;
+    }
+
     for (var i = 0; i < codes.length; ++i) {
         var code = codes[i];
         if (code.classList.contains(className)) {
-            if (renderFlowchartOne(code, flowchartIdx)) {
+            if (VLazyRendering) {
+                renderDiagramLazily(code, renderFlowchartOne);
+            } else if (renderFlowchartOne(code, flowchartIdx)) {
                 // replaceChild() will decrease codes.length.
                 --i;
             }
@@ -584,12 +985,13 @@ var getImageType = function(img) {
 };
 
 // Center the image block and insert the alt text as caption.
-var insertImageCaption = function() {
+// @root: only handle images within it if specified.
+var insertImageCaption = function(root) {
     if (!VEnableImageCaption) {
         return;
     }
 
-    var imgs = document.getElementsByTagName('img');
+    var imgs = (root || document).getElementsByTagName('img');
     for (var i = 0; i < imgs.length; ++i) {
         var img = imgs[i];
 
@@ -622,12 +1024,292 @@ var insertImageCaption = function() {
     }
 }
 
+// Whether @text may contain formulas for MathJax.
+var mayContainMath = function(text) {
+    return text.indexOf('$') != -1
+           || text.indexOf('\\(') != -1
+           || text.indexOf('\\[') != -1
+           || text.indexOf('\\begin') != -1;
+};
+
+// Whether @text defines TeX macros, which MathJax must see in every rendering.
+var definesMathMacro = function(text) {
+    return /\\(newcommand|renewcommand|def|let|DeclareMathOperator|newenvironment|renewenvironment)\b/.test(text);
+};
+
+var MathJaxCacheStorageKey = 'vnote_mathjax_cache';
+
+// Typeset HTML of top-level blocks keyed by their HTML before typesetting.
+// Entries are kept in the order of use and persisted in the local storage.
+var mathJaxCache = null;
+
+var mathJaxCacheSaveScheduled = false;
+
+// Whether MathJax has typeset something in this page, which will bring in
+// the styles needed by the cached output.
+var mathJaxStylesReady = false;
+
+// Macro definitions of current document, which are part of the cache key since
+// the output of other blocks depends on them.
+var mathJaxMacros = '';
+
+var fetchMathJaxCache = function() {
+    if (mathJaxCache) {
+        return mathJaxCache;
+    }
+
+    mathJaxCache = new Map();
+    try {
+        var data = JSON.parse(window.localStorage.getItem(MathJaxCacheStorageKey));
+        if (data && data.key == VMathjaxCacheKey) {
+            for (var i = 0; i < data.entries.length; ++i) {
+                mathJaxCache.set(data.entries[i][0], data.entries[i][1]);
+            }
+        }
+    } catch (err) {
+        content.setLog("fail to read MathJax cache: " + err);
+    }
+
+    return mathJaxCache;
+};
+
+var saveMathJaxCacheLater = function() {
+    if (mathJaxCacheSaveScheduled) {
+        return;
+    }
+
+    mathJaxCacheSaveScheduled = true;
+    runWhenIdle(function() {
+        mathJaxCacheSaveScheduled = false;
+        try {
+            var data = {
+                key: VMathjaxCacheKey,
+                entries: Array.from(mathJaxCache.entries())
+            };
+
+            window.localStorage.setItem(MathJaxCacheStorageKey, JSON.stringify(data));
+        } catch (err) {
+            content.setLog("fail to save MathJax cache: " + err);
+        }
+    });
+};
+
+// Whether the typeset result of @ele could be reused.
+var isMathJaxCacheable = function(ele) {
+    // Code blocks and diagrams will be altered later.
+    // Macros must be defined by MathJax itself.
+    return VMathjaxCacheSize > 0
+           && !ele.querySelector('pre, .' + VLazyDiagramClass)
+           && !definesMathMacro(ele.textContent);
+};
+
+var getMathJaxCache = function(key) {
+    var cache = fetchMathJaxCache();
+    var val = cache.get(key);
+    if (val !== undefined) {
+        // Mark it as recently used.
+        cache.delete(key);
+        cache.set(key, val);
+    }
+
+    return val;
+};
+
+// @source: HTML of @ele before typesetting.
+var setMathJaxCache = function(key, source, ele) {
+    var val = ele.innerHTML;
+    // Output with global SVG glyph cache is not self-contained.
+    if (val == source || val.indexOf('xlink:href="#MJ') != -1) {
+        return;
+    }
+
+    // Avoid duplicate ids with formulas typeset in the future.
+    val = val.replace(/ id="MathJax-(Element|Span)-[^"]*"/g, '');
+
+    var cache = fetchMathJaxCache();
+    cache.delete(key);
+    cache.set(key, val);
+    while (cache.size > VMathjaxCacheSize) {
+        cache.delete(cache.keys().next().value);
+    }
+
+    saveMathJaxCacheLater();
+};
+
+// Typeset a hidden formula to make sure MathJax has added its styles.
+var ensureMathJaxStyles = function() {
+    if (mathJaxStylesReady) {
+        return;
+    }
+
+    mathJaxStylesReady = true;
+    var div = document.createElement('div');
+    div.style.cssText = 'position: absolute; visibility: hidden; height: 0; overflow: hidden;';
+    div.textContent = '$x$';
+    document.body.appendChild(div);
+    MathJax.Hub.Queue(["Typeset", MathJax.Hub, div], function() {
+        div.remove();
+    });
+};
+
+// Typeset @ele, which is a block of the content, and then call @done.
+// Use the cached result if @ele has been typeset before.
+var typesetMathJaxBlock = function(ele, done) {
+    var cacheable = isMathJaxCacheable(ele);
+    var source = ele.innerHTML;
+    var key = cacheable ? mathJaxMacros + source : null;
+    if (cacheable) {
+        var val = getMathJaxCache(key);
+        if (val !== undefined) {
+            ensureMathJaxStyles();
+            ele.innerHTML = val;
+            done();
+            return;
+        }
+    }
+
+    try {
+        MathJax.Hub.Queue(["Typeset", MathJax.Hub, ele], function() {
+            mathJaxStylesReady = true;
+            if (cacheable) {
+                setMathJaxCache(key, source, ele);
+            }
+
+            done();
+        });
+    } catch (err) {
+        content.setLog("err: " + err);
+        done();
+    }
+};
+
+// Typeset formulas in @container and then call @callback.
+// In lazy mode, children of @container are typeset when they are about to be
+// visible, and @callback is called right away.
+var renderMathJax = function(container, callback) {
+    // MathJax may be not loaded for now.
+    if (!VEnableMathjax || typeof MathJax == "undefined") {
+        callback();
+        return;
+    }
+
+    var children = container.children;
+    mathJaxMacros = '';
+    for (var i = 0; i < children.length; ++i) {
+        if (definesMathMacro(children[i].textContent)) {
+            mathJaxMacros += children[i].textContent + '\n';
+        }
+    }
+
+    if (!VLazyRendering) {
+        var pending = 1;
+        var finishOne = function() {
+            if (--pending == 0) {
+                callback();
+            }
+        };
+
+        for (var i = 0; i < children.length; ++i) {
+            if (mayContainMath(children[i].textContent)) {
+                ++pending;
+                typesetMathJaxBlock(children[i], finishOne);
+            }
+        }
+
+        finishOne();
+        return;
+    }
+
+    // Blocks defining macros are typeset at once to make sure MathJax sees
+    // the definitions before the blocks using them.
+    for (var i = 0; i < children.length; ++i) {
+        if (definesMathMacro(children[i].textContent)) {
+            typesetMathJaxBlock(children[i], function() {});
+        }
+    }
+
+    for (var i = 0; i < children.length; ++i) {
+        var child = children[i];
+        if (mayContainMath(child.textContent) && !definesMathMacro(child.textContent)) {
+            addLazyRenderTask(child, (function(ele) {
+                return function(done) {
+                    typesetMathJaxBlock(ele, done);
+                };
+            })(child));
+        }
+    }
+
+    callback();
+};
+
+// Call @func when the page is idle.
+var runWhenIdle = function(func) {
+    if (typeof window.requestIdleCallback == 'function') {
+        window.requestIdleCallback(func, { timeout: 100 });
+    } else {
+        setTimeout(func, 0);
+    }
+};
+
 // The renderer specific code should call this function once thay have finished
 // markdown-specifi handle logics, such as Mermaid, MathJax.
 var finishLogics = function() {
+    invalidateHeaders(true);
+    autoDetectTimeSpent = 0;
     content.finishLogics();
 };
 
+// Max number of code blocks to cache the auto-detected highlight result.
+var AutoDetectCacheSize = 1000;
+
+// Code -> highlighted Html of code blocks with auto-detected language.
+// Kept across renderings so unchanged code blocks will not be detected again.
+var autoDetectCache = new Map();
+
+// Time in ms spent on auto detection in current rendering.
+var autoDetectTimeSpent = 0;
+
+var autoDetectLanguages = null;
+
+// Highlight @code whose language is not specified or not registered.
+// Only languages in VCodeBlockAutoDetectLanguages will be tried. Once the
+// time budget of current rendering is used up, return the escaped @code.
+var highlightCodeAuto = function(code) {
+    var html = autoDetectCache.get(code);
+    if (typeof html != 'undefined') {
+        return html;
+    }
+
+    if (VCodeBlockAutoDetectBudget > 0
+        && autoDetectTimeSpent >= VCodeBlockAutoDetectBudget) {
+        return escapeHtml(code);
+    }
+
+    if (!autoDetectLanguages) {
+        autoDetectLanguages = [];
+        var langs = VCodeBlockAutoDetectLanguages.split(',');
+        for (var i = 0; i < langs.length; ++i) {
+            var lang = langs[i].trim();
+            if (lang && hljs.getLanguage(lang)) {
+                autoDetectLanguages.push(lang);
+            }
+        }
+    }
+
+    var start = performance.now();
+    html = hljs.highlightAuto(code,
+                              autoDetectLanguages.length > 0 ? autoDetectLanguages : undefined).value;
+    autoDetectTimeSpent += performance.now() - start;
+
+    if (autoDetectCache.size >= AutoDetectCacheSize) {
+        // Map keeps the insertion order. Drop the oldest one.
+        autoDetectCache.delete(autoDetectCache.keys().next().value);
+    }
+
+    autoDetectCache.set(code, html);
+    return html;
+};
+
 // Escape @text to Html.
 var escapeHtml = function(text) {
   var map = {
@@ -730,6 +1412,8 @@ var tocToTree = function(p_toc, p_baseLevel) {
 };
 
 var handleToc = function(needToc) {
+    invalidateHeaders(true);
+
     var baseLevel = baseLevelOfToc(toc);
     var tocTree = tocToTree(toPerfectToc(toc, baseLevel), baseLevel);
     content.setToc(tocTree, baseLevel);
@@ -808,7 +1492,7 @@ window.onmousemove = function(e) {
 //                 negative value for upper level;
 //                 positive value is ignored.
 var jumpTitle = function(forward, relativeLevel, repeat) {
-    var headers = document.querySelectorAll("h1, h2, h3, h4, h5, h6");
+    var headers = fetchHeaders();
     if (headers.length == 0) {
         return;
     }
@@ -878,37 +1562,109 @@ var jumpTitle = function(forward, relativeLevel, repeat) {
     headers[targetIdx].scrollIntoView();
     highlightAnchor(headers[targetIdx]);
     currentHeaderIdx = targetIdx;
-    content.setHeader(headers[targetIdx].getAttribute("id"));
+    setCurrentHeader(headers[targetIdx].getAttribute("id"));
+    updateSourceLine();
     setTimeout("g_muteScroll = false", 100);
 };
 
-var renderCodeBlockLineNumber = function() {
+// Add line numbers to code block @code and delete the last extra row.
+var renderCodeBlockLineNumberOne = function(code) {
+    hljs.lineNumbersBlock(code);
+
+    var table = code.firstElementChild;
+    if (table && table.classList.contains("hljs-ln")) {
+        table.deleteRow(table.rows.length - 1);
+    }
+};
+
+// Code blocks waiting for line numbers in document order.
+var pendingLineNumberCodes = [];
+
+var lazyLineNumberScheduled = false;
+
+// @root: only handle code blocks within it if specified. The code blocks will
+// be appended to the pending ones of last call.
+var renderCodeBlockLineNumber = function(root) {
+    if (!root) {
+        pendingLineNumberCodes = [];
+    }
+
     if (!VEnableHighlightLineNumber) {
         return;
     }
 
-    var codes = document.getElementsByTagName('code');
+    var codes = (root || document).getElementsByTagName('code');
     for (var i = 0; i < codes.length; ++i) {
         var code = codes[i];
         if (code.parentElement.tagName.toLowerCase() == 'pre') {
-            hljs.lineNumbersBlock(code);
+            if (code.classList.contains(VLazyDiagramClass)) {
+                continue;
+            }
+
+            if (VLazyRendering) {
+                pendingLineNumberCodes.push(code);
+            } else {
+                renderCodeBlockLineNumberOne(code);
+            }
         }
     }
 
-    // Delete the last extra row.
-    var tables = document.getElementsByTagName('table');
-    for (var i = 0; i < tables.length; ++i) {
-        var table = tables[i];
-        if (table.classList.contains("hljs-ln")) {
-            var rowCount = table.rows.length;
-            table.deleteRow(rowCount - 1);
+    renderVisibleCodeBlockLineNumber();
+};
+
+// Add line numbers to pending code blocks near the viewport.
+var renderVisibleCodeBlockLineNumber = function() {
+    lazyLineNumberScheduled = false;
+    if (pendingLineNumberCodes.length == 0) {
+        return;
+    }
+
+    var top = -LazyRenderingMargin;
+    var bottom = window.innerHeight + LazyRenderingMargin;
+
+    // Code blocks are in document order, so find the first one not above
+    // the viewport by binary search.
+    var lo = 0;
+    var hi = pendingLineNumberCodes.length;
+    while (lo < hi) {
+        var mid = (lo + hi) >> 1;
+        if (pendingLineNumberCodes[mid].getBoundingClientRect().bottom < top) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
         }
     }
+
+    var end = lo;
+    while (end < pendingLineNumberCodes.length
+           && pendingLineNumberCodes[end].getBoundingClientRect().top <= bottom) {
+        ++end;
+    }
+
+    var codes = pendingLineNumberCodes.splice(lo, end - lo);
+    for (var i = 0; i < codes.length; ++i) {
+        renderCodeBlockLineNumberOne(codes[i]);
+    }
+
+    if (codes.length > 0) {
+        invalidateHeaders(false);
+    }
+};
+
+var scheduleLazyLineNumber = function() {
+    if (pendingLineNumberCodes.length > 0 && !lazyLineNumberScheduled) {
+        lazyLineNumberScheduled = true;
+        window.requestAnimationFrame(renderVisibleCodeBlockLineNumber);
+    }
 };
 
-var addClassToCodeBlock = function() {
+window.addEventListener('scroll', scheduleLazyLineNumber);
+window.addEventListener('resize', scheduleLazyLineNumber);
+
+// @root: only handle code blocks within it if specified.
+var addClassToCodeBlock = function(root) {
     var hljsClass = 'hljs';
-    var codes = document.getElementsByTagName('code');
+    var codes = (root || document).getElementsByTagName('code');
     for (var i = 0; i < codes.length; ++i) {
         var code = codes[i];
         if (code.parentElement.tagName.toLowerCase() == 'pre') {
@@ -952,9 +1708,26 @@ var initStylesToInline = function() {
     }
 };
 
+// Signature of the position of the @idx child among @count siblings, which
+// matters for selectors like :first-child and :nth-child(odd).
+var siblingSignature = function(idx, count) {
+    return (idx == 0 ? 'f' : '') + (idx == count - 1 ? 'l' : '') + (idx % 2);
+};
+
 // Embed the CSS styles of @ele and all its children.
-var embedInlineStyles = function(ele) {
+// @parentSig: signature of the ancestor chain of @ele.
+// @posSig: signature of the position of @ele among its siblings.
+// @styleCache: signature -> computed values of the properties. Elements with
+// the same tag, classes, inline style and ancestor chain share the same
+// computed styles, so getComputedStyle() is called once for each signature.
+var embedInlineStyles = function(ele, parentSig, posSig, styleCache) {
     var tagName = ele.tagName.toLowerCase();
+    var sig = parentSig + '>' + tagName
+              + '.' + (ele.getAttribute('class') || '')
+              + '#' + ele.id
+              + '[' + (ele.getAttribute('style') || '') + ']'
+              + posSig;
+
     var props = StylesToInline.get(tagName);
     if (!props) {
         props = StylesToInline.get('all');
@@ -965,16 +1738,28 @@ var embedInlineStyles = function(ele) {
     }
 
     // Embed itself.
-    var style = window.getComputedStyle(ele, null);
+    var values = styleCache.get(sig);
+    if (!values) {
+        var style = window.getComputedStyle(ele, null);
+        values = new Array(props.length);
+        for (var i = 0; i < props.length; ++i) {
+            values[i] = style.getPropertyValue(props[i]);
+        }
+
+        styleCache.set(sig, values);
+    }
+
     for (var i = 0; i < props.length; ++i) {
-        var pro = props[i];
-        ele.style.setProperty(pro, style.getPropertyValue(pro));
+        ele.style.setProperty(props[i], values[i]);
     }
 
     // Embed children.
     var children = ele.children;
     for (var i = 0; i < children.length; ++i) {
-        embedInlineStyles(children[i]);
+        embedInlineStyles(children[i],
+                          sig,
+                          siblingSignature(i, children.length),
+                          styleCache);
     }
 };
 
@@ -983,9 +1768,14 @@ var getHtmlWithInlineStyles = function(container) {
         initStylesToInline();
     }
 
+    // Styles may change between calls, so do not keep the cache.
+    var styleCache = new Map();
     var children = container.children;
     for (var i = 0; i < children.length; ++i) {
-        embedInlineStyles(children[i]);
+        embedInlineStyles(children[i],
+                          '',
+                          siblingSignature(i, children.length),
+                          styleCache);
     }
 
     return container.innerHTML;
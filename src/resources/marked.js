@@ -21,7 +21,7 @@ marked.setOptions({
             if (hljs.getLanguage(lang)) {
                 return hljs.highlight(lang, code).value;
             } else {
-                return hljs.highlightAuto(code).value;
+                return highlightCodeAuto(code);
             }
         } else {
             return code;
@@ -49,6 +49,7 @@ var updateText = function(text) {
     var needToc = mdHasTocSection(text);
     var html = markdownToHtml(text, needToc);
     placeholder.innerHTML = html;
+    resetLazyRendering();
     handleToc(needToc);
     insertImageCaption();
     renderMermaid('lang-mermaid');
@@ -58,16 +59,7 @@ var updateText = function(text) {
 
     // If you add new logics after handling MathJax, please pay attention to
     // finishLoading logic.
-    if (VEnableMathjax) {
-        try {
-            MathJax.Hub.Queue(["Typeset", MathJax.Hub, placeholder, finishLogics]);
-        } catch (err) {
-            content.setLog("err: " + err);
-            finishLogics();
-        }
-    } else {
-        finishLogics();
-    }
+    renderMathJax(placeholder, finishLogics);
 };
 
 var highlightText = function(text, id, timeStamp) {
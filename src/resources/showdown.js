@@ -73,6 +73,7 @@ var updateText = function(text) {
     var needToc = mdHasTocSection(text);
     var html = markdownToHtml(text, needToc);
     placeholder.innerHTML = html;
+    resetLazyRendering();
     handleToc(needToc);
     insertImageCaption();
     highlightCodeBlocks(document, VEnableMermaid, VEnableFlowchart);
@@ -83,16 +84,7 @@ var updateText = function(text) {
 
     // If you add new logics after handling MathJax, please pay attention to
     // finishLoading logic.
-    if (VEnableMathjax) {
-        try {
-            MathJax.Hub.Queue(["Typeset", MathJax.Hub, placeholder, finishLogics]);
-        } catch (err) {
-            content.setLog("err: " + err);
-            finishLogics();
-        }
-    } else {
-        finishLogics();
-    }
+    renderMathJax(placeholder, finishLogics);
 };
 
 var highlightText = function(text, id, timeStamp) {
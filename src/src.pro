@@ -106,7 +106,10 @@ SOURCES += main.cpp\
     dialog/vcopytextashtmldialog.cpp \
     vwaitingwidget.cpp \
     utils/vwebutils.cpp \
-    vlineedit.cpp
+    vlineedit.cpp \
+    vimagesaver.cpp \
+    vimagestore.cpp \
+    vpdfmerger.cpp
 
 HEADERS  += vmainwindow.h \
     vdirectorytree.h \
@@ -199,7 +202,10 @@ HEADERS  += vmainwindow.h \
     dialog/vcopytextashtmldialog.h \
     vwaitingwidget.h \
     utils/vwebutils.h \
-    vlineedit.h
+    vlineedit.h \
+    vimagesaver.h \
+    vimagestore.h \
+    vpdfmerger.h
 
 RESOURCES += \
     vnote.qrc \
@@ -2,81 +2,106 @@
 
 #include <QDebug>
 #include <QMimeData>
+#include <QTimer>
 
-#include "vutils.h"
+#include "vconfigmanager.h"
+#include "vmainwindow.h"
+
+extern VConfigManager *g_config;
+
+extern VMainWindow *g_mainWin;
+
+// Interval in ms between two attempts.
+static const int c_retryInterval = 100;
 
 void VClipboardUtils::setImageToClipboard(QClipboard *p_clipboard,
                                           const QImage &p_image,
                                           QClipboard::Mode p_mode)
 {
 #if defined(Q_OS_WIN)
-    // On Windows, setImage() may fail. We will repeatedly retry until succeed.
-    setImageLoop(p_clipboard, p_image, p_mode);
+    // On Windows, setImage() may fail. We will retry until succeed or time out.
+    startRetrier(new VClipboardRetrier(p_clipboard,
+                                       p_image,
+                                       p_mode,
+                                       g_config->getClipboardRetryTimeout(),
+                                       g_config->getClipboardRetryAttempts(),
+                                       p_clipboard));
 #else
     p_clipboard->setImage(p_image, p_mode);
 #endif
 }
 
-void VClipboardUtils::setImageLoop(QClipboard *p_clipboard,
-                                   const QImage &p_image,
-                                   QClipboard::Mode p_mode)
-{
-    while (true) {
-        p_clipboard->setImage(p_image, p_mode);
-
-        QImage image = p_clipboard->image(p_mode);
-        if (!image.isNull()) {
-            break;
-        }
-
-        qDebug() << "fail to set image, retry";
-
-        VUtils::sleepWait(100 /* ms */);
-    }
-}
-
 void VClipboardUtils::setMimeDataToClipboard(QClipboard *p_clipboard,
                                              QMimeData *p_mimeData,
                                              QClipboard::Mode p_mode)
 {
 #if defined(Q_OS_WIN)
-    // On Windows, setMimeData() may fail. We will repeatedly retry until succeed.
-    setMimeDataLoop(p_clipboard, p_mimeData, p_mode);
+    // On Windows, setMimeData() may fail. We will retry until succeed or time out.
+    startRetrier(new VClipboardRetrier(p_clipboard,
+                                       p_mimeData,
+                                       p_mode,
+                                       g_config->getClipboardRetryTimeout(),
+                                       g_config->getClipboardRetryAttempts(),
+                                       p_clipboard));
 #else
     p_clipboard->setMimeData(p_mimeData, p_mode);
 #endif
 }
 
-QMimeData *VClipboardUtils::cloneMimeData(const QMimeData *p_mimeData)
+void VClipboardUtils::startRetrier(VClipboardRetrier *p_retrier)
 {
+    QObject::connect(p_retrier, &VClipboardRetrier::failed,
+                     [](int p_attempts) {
+                         qWarning() << "fail to set clipboard after" << p_attempts << "attempts";
+                         if (g_mainWin) {
+                             g_mainWin->showStatusMessage(QObject::tr("Failed to set the clipboard"));
+                         }
+                     });
+
+    p_retrier->start();
+}
+
+QMimeData *VClipboardUtils::cloneMimeData(const QMimeData *p_mimeData,
+                                          const QStringList &p_skippedFormats)
+{
+    // The source is owned by the clipboard and will be deleted once the clone
+    // is set, so we could not forward to it. If it is a plain QMimeData of this
+    // process, like the clipboard data while we own the clipboard, the getters
+    // return implicitly shared data and the payload is not copied. Data of the
+    // platform clipboard is converted and copied by the getters.
     QMimeData *da = new QMimeData();
-    if (p_mimeData->hasUrls()) {
+    const QStringList formats = p_mimeData->formats();
+    auto needClone = [&formats, &p_skippedFormats](const QString &p_format) {
+        return formats.contains(p_format) && !p_skippedFormats.contains(p_format);
+    };
+
+    if (needClone("text/uri-list")) {
         da->setUrls(p_mimeData->urls());
     }
 
-    if (p_mimeData->hasText()) {
+    if (needClone("text/plain")) {
         da->setText(p_mimeData->text());
     }
 
-    if (p_mimeData->hasColor()) {
+    if (needClone("application/x-color")) {
         da->setColorData(p_mimeData->colorData());
     }
 
-    if (p_mimeData->hasHtml()) {
+    if (needClone("text/html")) {
         da->setHtml(p_mimeData->html());
     }
 
-    if (p_mimeData->hasImage()) {
+    if (needClone("application/x-qt-image")) {
         da->setImageData(p_mimeData->imageData());
     }
 
     return da;
 }
 
-static bool mimeDataEquals(const QMimeData *p_a, const QMimeData *p_b)
+bool VClipboardUtils::mimeDataEquals(const QMimeData *p_a, const QMimeData *p_b)
 {
-    if ((p_a && !p_b) || (!p_a && p_b)) {
-        return false;
+    if (!p_a || !p_b) {
+        return p_a == p_b;
     }
 
     if (p_a->hasUrls()) {
@@ -142,24 +167,105 @@ static bool mimeDataEquals(const QMimeData *p_a, const QMimeData *p_b)
     return true;
 }
 
-void VClipboardUtils::setMimeDataLoop(QClipboard *p_clipboard,
-                                      QMimeData *p_mimeData,
-                                      QClipboard::Mode p_mode)
+VClipboardRetrier::VClipboardRetrier(QClipboard *p_clipboard,
+                                     QMimeData *p_mimeData,
+                                     QClipboard::Mode p_mode,
+                                     int p_timeout,
+                                     int p_maxAttempts,
+                                     QObject *p_parent)
+    : QObject(p_parent),
+      m_clipboard(p_clipboard),
+      m_mode(p_mode),
+      m_mimeData(p_mimeData),
+      m_isImage(false)
 {
-    while (true) {
-        // Make a backup.
-        QMimeData *tmp = cloneMimeData(p_mimeData);
-
-        p_clipboard->setMimeData(p_mimeData, p_mode);
-        const QMimeData *out = p_clipboard->mimeData(p_mode);
-        if (mimeDataEquals(tmp, out)) {
-            delete tmp;
-            break;
+    init(p_timeout, p_maxAttempts);
+}
+
+VClipboardRetrier::VClipboardRetrier(QClipboard *p_clipboard,
+                                     const QImage &p_image,
+                                     QClipboard::Mode p_mode,
+                                     int p_timeout,
+                                     int p_maxAttempts,
+                                     QObject *p_parent)
+    : QObject(p_parent),
+      m_clipboard(p_clipboard),
+      m_mode(p_mode),
+      m_mimeData(NULL),
+      m_image(p_image),
+      m_isImage(true)
+{
+    init(p_timeout, p_maxAttempts);
+}
+
+VClipboardRetrier::~VClipboardRetrier()
+{
+    delete m_mimeData;
+}
+
+void VClipboardRetrier::init(int p_timeout, int p_maxAttempts)
+{
+    m_timeout = p_timeout;
+    m_maxAttempts = qMax(p_maxAttempts, 1);
+    m_attempts = 0;
+
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(c_retryInterval);
+    connect(m_timer, &QTimer::timeout,
+            this, &VClipboardRetrier::tryOnce);
+}
+
+void VClipboardRetrier::start()
+{
+    m_elapsed.start();
+    tryOnce();
+}
+
+void VClipboardRetrier::tryOnce()
+{
+    ++m_attempts;
+
+    bool ok = false;
+    if (m_isImage) {
+        m_clipboard->setImage(m_image, m_mode);
+        ok = !m_clipboard->image(m_mode).isNull();
+    } else {
+        QMimeData *data = m_mimeData;
+        if (m_attempts == 1) {
+            // Set the original data first to keep all its formats, some of
+            // which may be dropped by cloneMimeData().
+            m_mimeData = VClipboardUtils::cloneMimeData(data);
+        } else {
+            data = VClipboardUtils::cloneMimeData(m_mimeData);
         }
 
-        qDebug() << "fail to set mimeData, retry";
-        p_mimeData = tmp;
+        m_clipboard->setMimeData(data, m_mode);
+        ok = VClipboardUtils::mimeDataEquals(m_mimeData, m_clipboard->mimeData(m_mode));
+    }
+
+    if (ok) {
+        finish(true);
+        return;
+    }
+
+    if (m_attempts >= m_maxAttempts
+        || m_elapsed.elapsed() + c_retryInterval > m_timeout) {
+        finish(false);
+        return;
+    }
+
+    qDebug() << "fail to set clipboard, retry" << m_attempts;
+    m_timer->start();
+}
 
-        VUtils::sleepWait(100 /* ms */);
+void VClipboardRetrier::finish(bool p_succeeded)
+{
+    if (p_succeeded) {
+        emit succeeded();
+    } else {
+        emit failed(m_attempts);
     }
+
+    deleteLater();
 }
@@ -1,10 +1,86 @@
 #ifndef VCLIPBOARDUTILS_H
 #define VCLIPBOARDUTILS_H
 
+#include <QObject>
 #include <QImage>
 #include <QClipboard>
+#include <QStringList>
+#include <QElapsedTimer>
 
 class QMimeData;
+class QTimer;
+
+
+// Set data to clipboard and retry on failure without blocking the event loop.
+// It will give up after @p_timeout ms or @p_maxAttempts attempts.
+// It will delete itself when finished.
+class VClipboardRetrier : public QObject
+{
+    Q_OBJECT
+public:
+    // Will take the ownership of @p_mimeData.
+    VClipboardRetrier(QClipboard *p_clipboard,
+                      QMimeData *p_mimeData,
+                      QClipboard::Mode p_mode,
+                      int p_timeout,
+                      int p_maxAttempts,
+                      QObject *p_parent = nullptr);
+
+    VClipboardRetrier(QClipboard *p_clipboard,
+                      const QImage &p_image,
+                      QClipboard::Mode p_mode,
+                      int p_timeout,
+                      int p_maxAttempts,
+                      QObject *p_parent = nullptr);
+
+    ~VClipboardRetrier();
+
+    // Make the first attempt right now.
+    void start();
+
+    int attempts() const;
+
+signals:
+    void succeeded();
+
+    // Emitted when the deadline or attempt budget is exhausted.
+    void failed(int p_attempts);
+
+private slots:
+    void tryOnce();
+
+private:
+    void init(int p_timeout, int p_maxAttempts);
+
+    void finish(bool p_succeeded);
+
+    QClipboard *m_clipboard;
+
+    QClipboard::Mode m_mode;
+
+    // The data to set. The clipboard takes the ownership of the data we set,
+    // so we keep a clone of it after the first attempt.
+    QMimeData *m_mimeData;
+
+    QImage m_image;
+
+    bool m_isImage;
+
+    int m_timeout;
+
+    int m_maxAttempts;
+
+    int m_attempts;
+
+    QElapsedTimer m_elapsed;
+
+    QTimer *m_timer;
+};
+
+inline int VClipboardRetrier::attempts() const
+{
+    return m_attempts;
+}
 
 
 class VClipboardUtils
@@ -18,20 +94,23 @@ public:
                                        QMimeData *p_mimeData,
                                        QClipboard::Mode p_mode = QClipboard::Clipboard);
 
-    static QMimeData *cloneMimeData(const QMimeData *p_mimeData);
+    // Clone the standard formats of @p_mimeData. Payloads are shared only if
+    // @p_mimeData lives in this process, otherwise they are copied.
+    // Formats in @p_skippedFormats will not be cloned since the caller is
+    // about to override them.
+    static QMimeData *cloneMimeData(const QMimeData *p_mimeData,
+                                    const QStringList &p_skippedFormats = QStringList());
+
+    // Whether @p_a and @p_b contain the same standard formats.
+    static bool mimeDataEquals(const QMimeData *p_a, const QMimeData *p_b);
 
 private:
     VClipboardUtils()
     {
     }
 
-    static void setImageLoop(QClipboard *p_clipboard,
-                             const QImage &p_image,
-                             QClipboard::Mode p_mode);
-
-    static void setMimeDataLoop(QClipboard *p_clipboard,
-                                QMimeData *p_mimeData,
-                                QClipboard::Mode p_mode);
+    // Start a retrier with the deadline and attempt budget from the config.
+    static void startRetrier(VClipboardRetrier *p_retrier);
 };
 
 #endif // VCLIPBOARDUTILS_H
@@ -8,6 +8,7 @@
 #include <QMimeData>
 #include <QJsonObject>
 #include <QJsonDocument>
+#include <QJsonArray>
 #include <QDateTime>
 #include <QFileInfo>
 #include <QImageReader>
@@ -188,23 +189,32 @@ QVector<ImageLink> VUtils::fetchImagesFromMarkdownFile(VFile *p_file,
     }
 
     const QString &text = p_file->getContent();
-    if (text.isEmpty()) {
-        if (!isOpened) {
-            p_file->close();
-        }
+    if (!text.isEmpty()) {
+        images = fetchImagesFromMarkdownText(text, p_file->fetchBasePath(), p_file, p_type);
+    }
 
-        return images;
+    if (!isOpened) {
+        p_file->close();
     }
 
+    return images;
+}
+
+QVector<ImageLink> VUtils::fetchImagesFromMarkdownText(const QString &p_text,
+                                                       const QString &p_basePath,
+                                                       const VFile *p_file,
+                                                       ImageLink::ImageLinkType p_type)
+{
+    QVector<ImageLink> images;
+
     // Used to de-duplicate the links. Url as the key.
     QSet<QString> fetchedLinks;
 
-    QVector<VElementRegion> regions = fetchImageRegionsUsingParser(text);
+    QVector<VElementRegion> regions = fetchImageRegionsUsingParser(p_text);
     QRegExp regExp(c_imageLinkRegExp);
-    QString basePath = p_file->fetchBasePath();
     for (int i = 0; i < regions.size(); ++i) {
         const VElementRegion &reg = regions[i];
-        QString linkText = text.mid(reg.m_startPos, reg.m_endPos - reg.m_startPos);
+        QString linkText = p_text.mid(reg.m_startPos, reg.m_endPos - reg.m_startPos);
         bool matched = regExp.exactMatch(linkText);
         if (!matched) {
             // Image links with reference format will not match.
@@ -215,14 +225,14 @@ QVector<ImageLink> VUtils::fetchImagesFromMarkdownFile(VFile *p_file,
 
         ImageLink link;
         link.m_url = imageUrl;
-        QFileInfo info(basePath, imageUrl);
+        QFileInfo info(p_basePath, imageUrl);
         if (info.exists()) {
             if (info.isNativePath()) {
                 // Local file.
                 link.m_path = QDir::cleanPath(info.absoluteFilePath());
 
                 if (QDir::isRelativePath(imageUrl)) {
-                    link.m_type = p_file->isInternalImageFolder(VUtils::basePathFromPath(link.m_path)) ?
+                    link.m_type = (p_file && p_file->isInternalImageFolder(VUtils::basePathFromPath(link.m_path))) ?
                                   ImageLink::LocalRelativeInternal : ImageLink::LocalRelativeExternal;
                 } else {
                     link.m_type = ImageLink::LocalAbsolute;
@@ -246,11 +256,39 @@ QVector<ImageLink> VUtils::fetchImagesFromMarkdownFile(VFile *p_file,
         }
     }
 
-    if (!isOpened) {
-        p_file->close();
+    return images;
+}
+
+QString VUtils::replaceImageUrlsInMarkdown(const QString &p_text,
+                                          const QHash<QString, QString> &p_urls)
+{
+    if (p_urls.isEmpty()) {
+        return p_text;
     }
 
-    return images;
+    QString text = p_text;
+    QVector<VElementRegion> regions = fetchImageRegionsUsingParser(p_text);
+    QRegExp regExp(c_imageLinkRegExp);
+
+    // Replace from back to front to keep the positions valid.
+    for (int i = regions.size() - 1; i >= 0; --i) {
+        const VElementRegion &reg = regions[i];
+        QString linkText = p_text.mid(reg.m_startPos, reg.m_endPos - reg.m_startPos);
+        if (!regExp.exactMatch(linkText)) {
+            continue;
+        }
+
+        QString imageUrl = regExp.capturedTexts()[2].trimmed();
+        auto it = p_urls.find(imageUrl);
+        if (it == p_urls.end()) {
+            continue;
+        }
+
+        int urlPos = reg.m_startPos + regExp.pos(2) + regExp.cap(2).indexOf(imageUrl);
+        text.replace(urlPos, imageUrl.size(), it.value());
+    }
+
+    return text;
 }
 
 QString VUtils::imageLinkUrlToPath(const QString &p_basePath, const QString &p_url)
@@ -585,6 +623,18 @@ QString VUtils::generateSimpleHtmlTemplate(const QString &p_body)
     return html.replace(HtmlHolder::c_bodyHolder, p_body);
 }
 
+// Return @p_str as a JavaScript string literal which is safe within <script>.
+static QString toJavaScriptString(const QString &p_str)
+{
+    QJsonArray arr;
+    arr.append(p_str);
+    QString json = QString::fromUtf8(QJsonDocument(arr).toJson(QJsonDocument::Compact));
+
+    // Strip the brackets.
+    json = json.mid(1, json.size() - 2);
+    return json.replace("</", "<\\/");
+}
+
 QString VUtils::generateHtmlTemplate(MarkdownConverterType p_conType, bool p_exportPdf)
 {
     QString jsFile, extraFile;
@@ -653,8 +703,10 @@ QString VUtils::generateHtmlTemplate(MarkdownConverterType p_conType, bool p_exp
                      "                    showProcessingMessages: false,\n"
                      "                    messageStyle: \"none\"});\n"
                      "</script>\n"
-                     "<script type=\"text/javascript\" async src=\"" + g_config->getMathjaxJavascript() + "\"></script>\n" +
-                     "<script>var VEnableMathjax = true;</script>\n";
+                     "<script type=\"text/javascript\" async src=\"" + g_config->getMathjaxJavascript().toHtmlEscaped() + "\"></script>\n" +
+                     "<script>var VEnableMathjax = true;\n"
+                     "var VMathjaxCacheKey = " + toJavaScriptString(g_config->getMathjaxJavascript()) + ";\n"
+                     "var VMathjaxCacheSize = " + QString::number(g_config->getMathjaxCacheSize()) + ";</script>\n";
     }
 
     if (g_config->getEnableImageCaption()) {
@@ -668,6 +720,16 @@ QString VUtils::generateHtmlTemplate(MarkdownConverterType p_conType, bool p_exp
 
     extraFile += "<script>var VStylesToInline = '" + g_config->getStylesToInlineWhenCopied() + "';</script>\n";
 
+    // Render everything eagerly when exporting.
+    if (!p_exportPdf) {
+        extraFile += "<script>var VLazyRendering = true;</script>\n";
+    }
+
+    extraFile += QString("<script>var VCodeBlockAutoDetectLanguages = '%1';\n"
+                         "var VCodeBlockAutoDetectBudget = %2;</script>\n")
+                        .arg(g_config->getCodeBlockAutoDetectLanguages())
+                        .arg(g_config->getCodeBlockAutoDetectBudget());
+
     QString htmlTemplate;
     if (p_exportPdf) {
         htmlTemplate = VNote::s_markdownTemplatePDF;
@@ -5,6 +5,7 @@
 #include <QColor>
 #include <QVector>
 #include <QPair>
+#include <QHash>
 #include <QMessageBox>
 #include <QUrl>
 #include <QDir>
@@ -123,6 +124,19 @@ public:
     static QVector<ImageLink> fetchImagesFromMarkdownFile(VFile *p_file,
                                                           ImageLink::ImageLinkType p_type = ImageLink::All);
 
+    // Fetch all the image links in markdown text @p_text with base path @p_basePath.
+    // @p_file is used to tell internal images. If it is NULL, all local relative
+    // images are LocalRelativeExternal.
+    static QVector<ImageLink> fetchImagesFromMarkdownText(const QString &p_text,
+                                                          const QString &p_basePath,
+                                                          const VFile *p_file,
+                                                          ImageLink::ImageLinkType p_type = ImageLink::All);
+
+    // Replace the url of image links in markdown text @p_text according to
+    // @p_urls (old url -> new url) and return the new text.
+    static QString replaceImageUrlsInMarkdown(const QString &p_text,
+                                              const QHash<QString, QString> &p_urls);
+
     // Return the absolute path of @p_url according to @p_basePath.
     static QString imageLinkUrlToPath(const QString &p_basePath, const QString &p_url);
 
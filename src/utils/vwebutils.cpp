@@ -124,3 +124,127 @@ bool VWebUtils::translateColors(QString &p_html)
 
     return changed;
 }
+
+// A property name within a style attribute should follow a space or quote.
+static bool isPropertyBoundary(const QChar &p_ch)
+{
+    return p_ch.isSpace() || p_ch == '"';
+}
+
+static bool isPropertyNameChar(const QChar &p_ch)
+{
+    return p_ch.isLetterOrNumber() || p_ch == '-' || p_ch == '_';
+}
+
+// Whether tag [@p_start, @p_end) contains a style attribute.
+static bool tagHasStyle(const QString &p_html, int p_start, int p_end)
+{
+    const QLatin1String styleAttr("style=");
+    const int len = 6;
+    for (int i = p_start + 1; i + len <= p_end; ++i) {
+        if (p_html[i] == 's'
+            && p_html[i - 1].isSpace()
+            && p_html.midRef(i, len) == styleAttr) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool VWebUtils::removeStyles(QString &p_html, const QStringList &p_styles)
+{
+    if (p_styles.isEmpty()) {
+        return false;
+    }
+
+    bool changed = false;
+    const int size = p_html.size();
+
+    QString out;
+    // Start of the pending content in @p_html which is not appended to @out yet.
+    int pending = 0;
+
+    int pos = 0;
+    while (pos < size) {
+        if (p_html[pos] != '<') {
+            ++pos;
+            continue;
+        }
+
+        int tagStart = pos;
+        int tagEnd = p_html.indexOf('>', tagStart + 1);
+        if (tagEnd == -1) {
+            break;
+        }
+
+        pos = tagEnd + 1;
+        if (!tagHasStyle(p_html, tagStart, tagEnd)) {
+            continue;
+        }
+
+        // Scan properties within the tag.
+        int i = tagStart + 1;
+        while (i < tagEnd) {
+            // The char before the property. Use @out if the previous one is removed.
+            QChar prev = (i == pending && !out.isEmpty()) ? out[out.size() - 1] : p_html[i - 1];
+            if (!isPropertyBoundary(prev) || !isPropertyNameChar(p_html[i])) {
+                ++i;
+                continue;
+            }
+
+            int nameEnd = i;
+            while (nameEnd < tagEnd && isPropertyNameChar(p_html[nameEnd])) {
+                ++nameEnd;
+            }
+
+            if (nameEnd >= tagEnd || p_html[nameEnd] != ':') {
+                i = nameEnd;
+                continue;
+            }
+
+            // [^;]+; within the tag.
+            int valEnd = nameEnd + 1;
+            while (valEnd < tagEnd && p_html[valEnd] != ';') {
+                ++valEnd;
+            }
+
+            if (valEnd >= tagEnd || valEnd == nameEnd + 1) {
+                i = valEnd;
+                continue;
+            }
+
+            QStringRef name = p_html.midRef(i, nameEnd - i);
+            bool hit = false;
+            for (auto const & sty : p_styles) {
+                if (name == sty) {
+                    hit = true;
+                    break;
+                }
+            }
+
+            if (!hit) {
+                i = valEnd + 1;
+                continue;
+            }
+
+            // Drop [i, valEnd].
+            if (!changed) {
+                out.reserve(size);
+                changed = true;
+            }
+
+            out.append(p_html.constData() + pending, i - pending);
+            pending = valEnd + 1;
+            i = pending;
+        }
+    }
+
+    if (!changed) {
+        return false;
+    }
+
+    out.append(p_html.constData() + pending, size - pending);
+    p_html = out;
+    return true;
+}
@@ -3,6 +3,7 @@
 
 #include <QUrl>
 #include <QString>
+#include <QStringList>
 
 
 class VWebUtils
@@ -17,6 +18,10 @@ public:
     // Translate color styles in @p_html using mappings from VPalette.
     static bool translateColors(QString &p_html);
 
+    // Remove CSS properties @p_styles from the tags with style attribute in @p_html.
+    // It is done in one linear pass and @p_html is replaced at most once.
+    static bool removeStyles(QString &p_html, const QStringList &p_styles);
+
 private:
     VWebUtils();
 };
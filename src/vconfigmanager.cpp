@@ -9,6 +9,10 @@
 #include <QTextEdit>
 #include <QStandardPaths>
 #include <QCoreApplication>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QUrl>
+#include <QFileInfo>
 #include "utils/vutils.h"
 #include "vstyleparser.h"
 #include "vpalette.h"
@@ -33,6 +37,10 @@ const QString VConfigManager::c_snippetConfigFile = QString("snippet.json");
 
 const QString VConfigManager::c_styleConfigFolder = QString("styles");
 
+const QString VConfigManager::c_styleCacheFolder = QString("style_cache");
+
+const QString VConfigManager::c_webCacheFolder = QString("web_cache");
+
 const QString VConfigManager::c_themeConfigFolder = QString("themes");
 
 const QString VConfigManager::c_codeBlockStyleConfigFolder = QString("codeblock_styles");
@@ -238,8 +246,8 @@ void VConfigManager::initialize()
     m_confirmReloadFolder = getConfigFromSettings("global",
                                                   "confirm_reload_folder").toBool();
 
-    m_mathjaxJavascript = getConfigFromSettings("web",
-                                                "mathjax_javascript").toString();
+    m_mathjaxJavascript = resolveMathjaxJavascript(getConfigFromSettings("web",
+                                                                         "mathjax_javascript").toString());
 
     m_doubleClickCloseTab = getConfigFromSettings("global",
                                                   "double_click_close_tab").toBool();
@@ -285,6 +293,15 @@ void VConfigManager::initialize()
     m_closeBeforeExternalEditor = getConfigFromSettings("global",
                                                         "close_before_external_editor").toBool();
 
+    m_enableImageDedup = getConfigFromSettings("global",
+                                               "enable_image_dedup").toBool();
+
+    m_clipboardRetryTimeout = getConfigFromSettings("global",
+                                                    "clipboard_retry_timeout").toInt();
+
+    m_clipboardRetryAttempts = getConfigFromSettings("global",
+                                                     "clipboard_retry_attempts").toInt();
+
     m_fixImageSrcInWebWhenCopied = getConfigFromSettings("web",
                                                          "fix_img_src_when_copied").toBool();
 
@@ -293,6 +310,18 @@ void VConfigManager::initialize()
 
     m_stylesToInlineWhenCopied = getConfigFromSettings("web",
                                                        "styles_to_inline_when_copied").toStringList().join(",");
+
+    m_codeBlockAutoDetectLanguages = getConfigFromSettings("web",
+                                                           "code_block_auto_detect_languages").toStringList().join(",");
+
+    m_codeBlockAutoDetectBudget = getConfigFromSettings("web",
+                                                        "code_block_auto_detect_budget").toInt();
+
+    m_mathjaxCacheSize = getConfigFromSettings("web",
+                                               "mathjax_cache_size").toInt();
+
+    m_pdfExportPartSize = getConfigFromSettings("web",
+                                                "pdf_export_part_size").toInt();
 }
 
 void VConfigManager::initSettings()
@@ -581,14 +610,27 @@ void VConfigManager::updateMarkdownEditStyle()
     mdEditPalette = baseEditPalette;
     mdEditFont = baseEditFont;
 
-    VStyleParser parser;
-    parser.parseMarkdownStyle(styleStr);
+    // The resolved styles depend only on the style file and the base font
+    // and palette.
+    QByteArray key;
+    {
+        QDataStream stream(&key, QIODevice::WriteOnly);
+        stream << QString(qVersion()) << styleStr << baseEditFont.toString() << baseEditPalette;
+        key = QCryptographicHash::hash(key, QCryptographicHash::Sha1);
+    }
 
     QMap<QString, QMap<QString, QString>> styles;
-    parser.fetchMarkdownEditorStyles(mdEditPalette, mdEditFont, styles);
+    if (!readMarkdownEditStyleCache(key, styles)) {
+        VStyleParser parser;
+        parser.parseMarkdownStyle(styleStr);
+
+        parser.fetchMarkdownEditorStyles(mdEditPalette, mdEditFont, styles);
+
+        mdHighlightingStyles = parser.fetchMarkdownStyles(mdEditFont);
+        m_codeBlockStyles = parser.fetchCodeBlockStyles(mdEditFont);
 
-    mdHighlightingStyles = parser.fetchMarkdownStyles(mdEditFont);
-    m_codeBlockStyles = parser.fetchCodeBlockStyles(mdEditFont);
+        writeMarkdownEditStyleCache(key, styles);
+    }
 
     m_editorCurrentLineBg = defaultColor;
     m_editorVimInsertBg = defaultColor;
@@ -775,6 +817,33 @@ QString VConfigManager::getConfigFolder() const
     return VUtils::basePathFromPath(iniPath);
 }
 
+QString VConfigManager::resolveMathjaxJavascript(const QString &p_js) const
+{
+    QString js = p_js.trimmed();
+    if (js.isEmpty()
+        || js.startsWith("http:", Qt::CaseInsensitive)
+        || js.startsWith("https:", Qt::CaseInsensitive)
+        || js.startsWith("qrc:", Qt::CaseInsensitive)
+        || js.startsWith("file:", Qt::CaseInsensitive)) {
+        return js;
+    }
+
+    // Local path, with an optional query like "?config=TeX-MML-AM_CHTML".
+    QString query;
+    int idx = js.indexOf('?');
+    if (idx > -1) {
+        query = js.mid(idx);
+        js = js.left(idx);
+    }
+
+    QString path = QDir(getConfigFolder()).absoluteFilePath(js);
+    if (!QFileInfo::exists(path)) {
+        qWarning() << "local MathJax does not exist" << path;
+    }
+
+    return QUrl::fromLocalFile(path).toString() + query;
+}
+
 QString VConfigManager::getConfigFilePath() const
 {
     V_ASSERT(userSettings);
@@ -788,6 +857,107 @@ const QString &VConfigManager::getStyleConfigFolder() const
     return path;
 }
 
+const QString &VConfigManager::getStyleCacheFolder() const
+{
+    static QString path = QDir(getConfigFolder()).filePath(c_styleCacheFolder);
+    return path;
+}
+
+const QString &VConfigManager::getWebCacheFolder() const
+{
+    static QString path = QDir(getConfigFolder()).filePath(c_webCacheFolder);
+    return path;
+}
+
+// Bump it when the layout of the cache file changes.
+static const quint32 c_markdownEditStyleCacheMagic = 0x564d4401;
+
+static const QString c_markdownEditStyleCacheFile = "markdown_edit_style.cache";
+
+bool VConfigManager::readMarkdownEditStyleCache(const QByteArray &p_key,
+                                                QMap<QString, QMap<QString, QString>> &p_styles)
+{
+    QFile file(QDir(getStyleCacheFolder()).filePath(c_markdownEditStyleCacheFile));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    quint32 magic = 0;
+    QByteArray key;
+    stream >> magic >> key;
+    if (magic != c_markdownEditStyleCacheMagic || key != p_key) {
+        return false;
+    }
+
+    QPalette palette;
+    QFont font;
+    QMap<QString, QMap<QString, QString>> styles;
+    stream >> palette >> font >> styles;
+
+    qint32 cnt = 0;
+    stream >> cnt;
+    QVector<HighlightingStyle> hlStyles;
+    for (qint32 i = 0; i < cnt && stream.status() == QDataStream::Ok; ++i) {
+        qint32 type;
+        QTextFormat fmt;
+        stream >> type >> fmt;
+        hlStyles.append(HighlightingStyle{(pmh_element_type)type, fmt.toCharFormat()});
+    }
+
+    stream >> cnt;
+    QHash<QString, QTextCharFormat> codeBlockStyles;
+    for (qint32 i = 0; i < cnt && stream.status() == QDataStream::Ok; ++i) {
+        QString name;
+        QTextFormat fmt;
+        stream >> name >> fmt;
+        codeBlockStyles.insert(name, fmt.toCharFormat());
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qWarning() << "invalid Markdown edit style cache" << file.fileName();
+        return false;
+    }
+
+    mdEditPalette = palette;
+    mdEditFont = font;
+    p_styles = styles;
+    mdHighlightingStyles = hlStyles;
+    m_codeBlockStyles = codeBlockStyles;
+
+    qDebug() << "use cached Markdown edit style" << file.fileName();
+    return true;
+}
+
+void VConfigManager::writeMarkdownEditStyleCache(const QByteArray &p_key,
+                                                 const QMap<QString, QMap<QString, QString>> &p_styles) const
+{
+    QDir dir(getStyleCacheFolder());
+    if (!dir.exists() && !dir.mkpath(dir.absolutePath())) {
+        return;
+    }
+
+    QFile file(dir.filePath(c_markdownEditStyleCacheFile));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "fail to write Markdown edit style cache" << file.fileName();
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream << c_markdownEditStyleCacheMagic << p_key;
+    stream << mdEditPalette << mdEditFont << p_styles;
+
+    stream << (qint32)mdHighlightingStyles.size();
+    for (auto const & style : mdHighlightingStyles) {
+        stream << (qint32)style.type << style.format;
+    }
+
+    stream << (qint32)m_codeBlockStyles.size();
+    for (auto it = m_codeBlockStyles.begin(); it != m_codeBlockStyles.end(); ++it) {
+        stream << it.key() << it.value();
+    }
+}
+
 const QString &VConfigManager::getThemeConfigFolder() const
 {
     static QString path = QDir(getConfigFolder()).filePath(c_themeConfigFolder);
@@ -369,6 +369,12 @@ public:
     // Get the folder c_styleConfigFolder in the config folder.
     const QString &getStyleConfigFolder() const;
 
+    // Get the folder c_styleCacheFolder in the config folder.
+    const QString &getStyleCacheFolder() const;
+
+    // Get the folder c_webCacheFolder in the config folder.
+    const QString &getWebCacheFolder() const;
+
     // Get the folder c_templateConfigFolder in the config folder.
     const QString &getTemplateConfigFolder() const;
 
@@ -432,6 +438,20 @@ public:
 
     const QString &getStylesToInlineWhenCopied() const;
 
+    bool getEnableImageDedup() const;
+
+    int getClipboardRetryTimeout() const;
+
+    int getClipboardRetryAttempts() const;
+
+    const QString &getCodeBlockAutoDetectLanguages() const;
+
+    int getCodeBlockAutoDetectBudget() const;
+
+    int getMathjaxCacheSize() const;
+
+    int getPdfExportPartSize() const;
+
 private:
     // Look up a config from user and default settings.
     QVariant getConfigFromSettings(const QString &section, const QString &key) const;
@@ -461,6 +481,10 @@ private:
     // Init from m_sessionSettings.
     void initFromSessionSettings();
 
+    // Convert a local path of MathJax to URL. Relative path is relative to
+    // the config folder.
+    QString resolveMathjaxJavascript(const QString &p_js) const;
+
     // Read [notebooks] section from @p_settings.
     void readNotebookFromSettings(QSettings *p_settings,
                                   QVector<VNotebook *> &p_notebooks,
@@ -478,6 +502,14 @@ private:
 
     void updateMarkdownEditStyle();
 
+    // Read resolved Markdown editor styles from the cache file.
+    // Return false if the cache does not exist or does not match @p_key.
+    bool readMarkdownEditStyleCache(const QByteArray &p_key,
+                                    QMap<QString, QMap<QString, QString>> &p_styles);
+
+    void writeMarkdownEditStyleCache(const QByteArray &p_key,
+                                     const QMap<QString, QMap<QString, QString>> &p_styles) const;
+
     // See if the old c_obsoleteDirConfigFile exists. If so, rename it to
     // the new one; if not, use the c_dirConfigFile.
     static QString fetchDirConfigFilePath(const QString &p_path);
@@ -831,6 +863,28 @@ private:
     // The string containing styles to inline when copied in edit mode.
     QString m_stylesToInlineWhenCopied;
 
+    // Whether store identical images only once within a notebook.
+    bool m_enableImageDedup;
+
+    // Deadline in ms to retry setting the clipboard.
+    int m_clipboardRetryTimeout;
+
+    // Max attempts to set the clipboard.
+    int m_clipboardRetryAttempts;
+
+    // Languages to try when detecting the language of code blocks in read mode.
+    // Separated by ,. Empty to try all the languages.
+    QString m_codeBlockAutoDetectLanguages;
+
+    // Time in ms per rendering to spend on detecting the language of code blocks.
+    int m_codeBlockAutoDetectBudget;
+
+    // Max number of typeset blocks of MathJax to cache across renderings.
+    int m_mathjaxCacheSize;
+
+    // Size in KB of the Markdown of each part when exporting a note to PDF in parts.
+    int m_pdfExportPartSize;
+
     // The name of the config file in each directory, obsolete.
     // Use c_dirConfigFile instead.
     static const QString c_obsoleteDirConfigFile;
@@ -863,6 +917,12 @@ private:
     // The folder name of style files.
     static const QString c_styleConfigFolder;
 
+    // The folder name of the cache of resolved styles.
+    static const QString c_styleCacheFolder;
+
+    // The folder name of the cache and storage of the preview pages.
+    static const QString c_webCacheFolder;
+
     // The folder name of theme files.
     static const QString c_themeConfigFolder;
 
@@ -2012,4 +2072,39 @@ inline const QString &VConfigManager::getStylesToInlineWhenCopied() const
 {
     return m_stylesToInlineWhenCopied;
 }
+
+inline bool VConfigManager::getEnableImageDedup() const
+{
+    return m_enableImageDedup;
+}
+
+inline int VConfigManager::getClipboardRetryTimeout() const
+{
+    return m_clipboardRetryTimeout;
+}
+
+inline int VConfigManager::getClipboardRetryAttempts() const
+{
+    return m_clipboardRetryAttempts;
+}
+
+inline const QString &VConfigManager::getCodeBlockAutoDetectLanguages() const
+{
+    return m_codeBlockAutoDetectLanguages;
+}
+
+inline int VConfigManager::getCodeBlockAutoDetectBudget() const
+{
+    return m_codeBlockAutoDetectBudget;
+}
+
+inline int VConfigManager::getMathjaxCacheSize() const
+{
+    return m_mathjaxCacheSize;
+}
+
+inline int VConfigManager::getPdfExportPartSize() const
+{
+    return m_pdfExportPartSize;
+}
 #endif // VCONFIGMANAGER_H
@@ -3,8 +3,10 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QDebug>
+#include <QSet>
 #include "vconfigmanager.h"
 #include "vnotefile.h"
+#include "vimagestore.h"
 #include "utils/vutils.h"
 
 extern VConfigManager *g_config;
@@ -438,6 +440,17 @@ bool VDirectory::deleteDirectory(bool p_skipRecycleBin, QString *p_errMsg)
     // Delete the entire directory.
     bool ret = true;
     QString dirPath = fetchPath();
+
+    // Keep images within it which are still used by notes outside.
+    VImageStore *store = m_notebook->getImageStore();
+    if (store) {
+        if (!store->releaseFolder(dirPath, p_errMsg)) {
+            ret = false;
+        }
+
+        store->flush();
+    }
+
     if (!VUtils::deleteDirectory(m_notebook, dirPath, p_skipRecycleBin)) {
         VUtils::addErrMsg(p_errMsg, tr("Fail to delete the directory %1.").arg(dirPath));
         ret = false;
@@ -529,6 +542,12 @@ bool VDirectory::rename(const QString &p_name)
         return false;
     }
 
+    VImageStore *store = m_notebook->getImageStore();
+    if (store) {
+        store->renamePath(dir.filePath(oldName), fetchPath());
+        store->flush();
+    }
+
     qDebug() << "folder renamed from" << oldName << "to" << m_name;
 
     return true;
@@ -561,6 +580,8 @@ bool VDirectory::copyDirectory(VDirectory *p_destDir,
 
     Q_ASSERT(paDir->isOpened());
 
+    VImageStore *srcStore = p_dir->getNotebook()->getImageStore();
+
     // Copy the directory.
     if (!VUtils::copyDirectory(srcPath, destPath, p_isCut)) {
         VUtils::addErrMsg(p_errMsg, tr("Fail to %1 the folder.").arg(opStr));
@@ -588,6 +609,28 @@ bool VDirectory::copyDirectory(VDirectory *p_destDir,
         return false;
     }
 
+    // Keep the references of notes within it.
+    VImageStore *destStore = p_destDir->getNotebook()->getImageStore();
+    if (p_isCut && srcStore && srcStore == destStore) {
+        srcStore->renamePath(srcPath, destPath);
+    } else {
+        if (p_isCut && srcStore) {
+            srcStore->removeReferences(srcPath);
+        }
+
+        if (destStore) {
+            destStore->scanReferences(destPath);
+        }
+    }
+
+    if (srcStore) {
+        srcStore->flush();
+    }
+
+    if (destStore && destStore != srcStore) {
+        destStore->flush();
+    }
+
     qDebug() << "copyDirectory:" << p_dir << "to" << destDir;
 
     *p_targetDir = destDir;
@@ -716,3 +759,42 @@ bool VDirectory::sortSubDirectories(const QVector<int> &p_sortedIdx)
 
     return ret;
 }
+
+void VDirectory::auditAttachments(QVector<QString> &p_missing, QVector<QString> &p_unlisted)
+{
+    bool opened = isOpened();
+    if (!open()) {
+        return;
+    }
+
+    QSet<QString> usedFolders;
+    for (auto file : m_files) {
+        const QString &folder = file->getAttachmentFolder();
+        if (folder.isEmpty()) {
+            continue;
+        }
+
+        usedFolders.insert(folder);
+        file->auditAttachments(p_missing, p_unlisted);
+    }
+
+    // Folders in the attachment folder which do not belong to any note.
+    QDir attaDir(QDir(fetchPath()).filePath(m_notebook->getAttachmentFolder()));
+    if (attaDir.exists()) {
+        QStringList entries = attaDir.entryList(QDir::Dirs | QDir::Files | QDir::Hidden | QDir::NoDotAndDotDot,
+                                                QDir::Name);
+        for (auto const & entry : entries) {
+            if (!usedFolders.contains(entry)) {
+                p_unlisted.push_back(attaDir.filePath(entry));
+            }
+        }
+    }
+
+    for (auto dir : m_subDirs) {
+        dir->auditAttachments(p_missing, p_unlisted);
+    }
+
+    if (!opened) {
+        close();
+    }
+}
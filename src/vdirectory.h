@@ -114,6 +114,13 @@ public:
     // Reorder sub-directories in m_subDirs by index.
     bool sortSubDirectories(const QVector<int> &p_sortedIdx);
 
+    // Check attachments of all the notes within this directory recursively.
+    // @p_missing: paths of attachments missing in disk;
+    // @p_unlisted: paths of files or folders in attachment folders which do
+    // not belong to any note.
+    // Will open and close sub-directories if they are not opened.
+    void auditAttachments(QVector<QString> &p_missing, QVector<QString> &p_unlisted);
+
     // Delete directory @p_dir.
     static bool deleteDirectory(VDirectory *p_dir,
                                 bool p_skipRecycleBin = false,
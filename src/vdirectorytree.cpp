@@ -12,6 +12,7 @@
 #include "dialog/vsortdialog.h"
 #include "utils/vimnavigationforwidget.h"
 #include "utils/viconutils.h"
+#include "vimagestore.h"
 
 extern VMainWindow *g_mainWin;
 
@@ -683,6 +684,12 @@ void VDirectoryTree::reloadFromDisk()
         buildSubTree(curItem, 1);
 
         setCurrentItem(curItem);
+
+        VImageStore *store = m_notebook->getImageStore();
+        if (store) {
+            store->scanReferences(curDir->fetchPath());
+            store->flush();
+        }
     } else {
         if (!m_editArea->closeFile(m_notebook, false)) {
             return;
@@ -701,6 +708,11 @@ void VDirectoryTree::reloadFromDisk()
             return;
         }
 
+        VImageStore *store = m_notebook->getImageStore();
+        if (store) {
+            store->reload();
+        }
+
         updateDirectoryTree();
     }
 
@@ -4,6 +4,7 @@
 
 VDocument::VDocument(const VFile *v_file, QObject *p_parent)
     : QObject(p_parent),
+      m_sourceLine(-1),
       m_file(v_file),
       m_readyToHighlight(false)
 {
@@ -11,8 +12,11 @@ VDocument::VDocument(const VFile *v_file, QObject *p_parent)
 
 void VDocument::updateText()
 {
+    m_sourceLine = -1;
     if (m_file) {
         emit textChanged(m_file->getContent());
+    } else if (!m_content.isNull()) {
+        emit textChanged(m_content);
     }
 }
 
@@ -37,6 +41,18 @@ void VDocument::scrollToAnchor(const QString &anchor)
     emit requestScrollToAnchor(anchor);
 }
 
+void VDocument::scrollToLine(int p_line)
+{
+    m_sourceLine = p_line;
+
+    emit requestScrollToLine(p_line);
+}
+
+void VDocument::setSourceLine(int p_line)
+{
+    m_sourceLine = p_line;
+}
+
 void VDocument::setHeader(const QString &anchor)
 {
     if (anchor == m_header) {
@@ -103,6 +119,11 @@ void VDocument::setFile(const VFile *p_file)
     m_file = p_file;
 }
 
+void VDocument::setContent(const QString &p_content)
+{
+    m_content = p_content;
+}
+
 void VDocument::finishLogics()
 {
     qDebug() << "Web side finished logics";
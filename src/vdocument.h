@@ -23,6 +23,12 @@ public:
     // @anchor is the id without '#', like "toc_1". If empty, will scroll to top.
     void scrollToAnchor(const QString &anchor);
 
+    // Scroll to make source line @p_line (0-based) at the top in the web.
+    void scrollToLine(int p_line);
+
+    // Source line (0-based) at the top of the web view, or -1 if unknown.
+    int getSourceLine() const;
+
     void setHtml(const QString &html);
 
     // Request to highlight a segment text.
@@ -34,6 +40,10 @@ public:
 
     void setFile(const VFile *p_file);
 
+    // Render @p_content instead of the content of the file.
+    // Only works when there is no file.
+    void setContent(const QString &p_content);
+
     bool isReadyToHighlight() const;
 
     bool isReadyToTextToHtml() const;
@@ -51,6 +61,9 @@ public slots:
     // The header does not begins with '#'.
     void setHeader(const QString &anchor);
 
+    // When the Web view stops scrolling, it will signal the source line at the top.
+    void setSourceLine(int p_line);
+
     void setLog(const QString &p_log);
     void keyPressEvent(int p_key, bool p_ctrl, bool p_shift);
     void updateText();
@@ -74,6 +87,8 @@ signals:
 
     void requestScrollToAnchor(const QString &anchor);
 
+    void requestScrollToLine(int p_line);
+
     // @anchor is the id of that anchor, without '#'.
     void headerChanged(const QString &anchor);
 
@@ -99,6 +114,9 @@ private:
     QString m_toc;
     QString m_header;
 
+    // Source line at the top of the web view, or -1.
+    int m_sourceLine;
+
     // m_text does NOT contain actual content.
     QString m_text;
 
@@ -107,6 +125,9 @@ private:
 
     const VFile *m_file;
 
+    // Content to render when m_file is NULL.
+    QString m_content;
+
     // Whether the web side is ready to handle highlight text request.
     bool m_readyToHighlight;
 
@@ -123,4 +144,9 @@ inline bool VDocument::isReadyToTextToHtml() const
 {
     return m_readyToTextToHtml;
 }
+
+inline int VDocument::getSourceLine() const
+{
+    return m_sourceLine;
+}
 #endif // VDOCUMENT_H
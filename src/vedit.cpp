@@ -121,7 +121,12 @@ void VEdit::saveFile()
 
 void VEdit::reloadFile()
 {
+    // The line distance height set on the new content should not be
+    // recorded in the undo history.
+    QTextDocument *doc = document();
+    doc->setUndoRedoEnabled(false);
     setHtml(m_file->getContent());
+    doc->setUndoRedoEnabled(true);
 
     setModified(false);
 }
@@ -1357,34 +1362,40 @@ void VEdit::updateBlockLineDistanceHeight(int p_pos,
     QTextDocument *doc = document();
     QTextBlock block = doc->findBlock(p_pos);
     QTextBlock lastBlock = doc->findBlock(p_pos + p_charsRemoved + p_charsAdded);
-    QTextCursor cursor(block);
-    bool changed = false;
+    if (!lastBlock.isValid()) {
+        lastBlock = doc->lastBlock();
+    }
+
+    // Skip the leading blocks already set, which is the common case when typing.
     while (block.isValid()) {
-        cursor.setPosition(block.position());
-        QTextBlockFormat fmt = cursor.blockFormat();
+        QTextBlockFormat fmt = block.blockFormat();
         if (fmt.lineHeightType() != QTextBlockFormat::LineDistanceHeight
             || fmt.lineHeight() != m_config.m_lineDistanceHeight) {
-            fmt.setLineHeight(m_config.m_lineDistanceHeight,
-                              QTextBlockFormat::LineDistanceHeight);
-            if (!changed) {
-                changed = true;
-                cursor.joinPreviousEditBlock();
-            }
-
-            cursor.mergeBlockFormat(fmt);
-            qDebug() << "merge block format line distance" << block.blockNumber();
+            break;
         }
 
         if (block == lastBlock) {
-            break;
+            return;
         }
 
         block = block.next();
     }
 
-    if (changed) {
-        cursor.endEditBlock();
+    if (!block.isValid()) {
+        return;
     }
+
+    // Merge the format of all the affected blocks at once, which results in
+    // only one relayout.
+    QTextBlockFormat fmt;
+    fmt.setLineHeight(m_config.m_lineDistanceHeight,
+                      QTextBlockFormat::LineDistanceHeight);
+
+    QTextCursor cursor(block);
+    cursor.setPosition(lastBlock.position(), QTextCursor::KeepAnchor);
+    cursor.joinPreviousEditBlock();
+    cursor.mergeBlockFormat(fmt);
+    cursor.endEditBlock();
 }
 
 void VEdit::evaluateMagicWords()
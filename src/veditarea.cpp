@@ -242,6 +242,10 @@ out:
 QVector<QPair<int, int> > VEditArea::findTabsByFile(const VFile *p_file)
 {
     QVector<QPair<int, int> > tabs;
+    if (findEditTabs(p_file).isEmpty()) {
+        return tabs;
+    }
+
     int nrWin = splitter->count();
     for (int winIdx = 0; winIdx < nrWin; ++winIdx) {
         VEditWindow *win = getWindow(winIdx);
@@ -600,6 +604,40 @@ void VEditArea::moveTab(QWidget *p_widget, int p_fromIdx, int p_toIdx)
     }
 }
 
+void VEditArea::registerEditTab(VEditTab *p_tab)
+{
+    const VFile *file = p_tab->getFile();
+    if (!file || m_tabFiles.contains(p_tab)) {
+        return;
+    }
+
+    m_tabFiles.insert(p_tab, file);
+    m_fileTabs[file].append(p_tab);
+}
+
+void VEditArea::unregisterEditTab(VEditTab *p_tab)
+{
+    auto it = m_tabFiles.find(p_tab);
+    if (it == m_tabFiles.end()) {
+        return;
+    }
+
+    auto fit = m_fileTabs.find(it.value());
+    if (fit != m_fileTabs.end()) {
+        fit.value().removeAll(p_tab);
+        if (fit.value().isEmpty()) {
+            m_fileTabs.erase(fit);
+        }
+    }
+
+    m_tabFiles.erase(it);
+}
+
+QVector<VEditTab *> VEditArea::findEditTabs(const VFile *p_file) const
+{
+    return m_fileTabs.value(p_file);
+}
+
 // Only propogate the search in the IncrementalSearch case.
 void VEditArea::handleFindTextChanged(const QString &p_text, uint p_options)
 {
@@ -808,6 +846,55 @@ int VEditArea::openFiles(const QVector<VFileSessionInfo> &p_files)
     return nrOpened;
 }
 
+void VEditArea::openFiles(const QVector<VFile *> &p_files,
+                          OpenFileMode p_mode,
+                          bool p_forceMode)
+{
+    if (p_mode != OpenFileMode::Read) {
+        for (auto file : p_files) {
+            openFile(file, p_mode, p_forceMode);
+        }
+
+        return;
+    }
+
+    // The last file to open in a tab, which will be the current one.
+    VFile *lastFile = NULL;
+    for (int i = p_files.size() - 1; i >= 0; --i) {
+        if (p_files[i] && p_files[i]->getDocType() != DocType::Unknown) {
+            lastFile = p_files[i];
+            break;
+        }
+    }
+
+    for (auto file : p_files) {
+        if (!file || file == lastFile) {
+            continue;
+        }
+
+        bool opened = !findTabsByFile(file).isEmpty();
+        if (opened && !p_forceMode) {
+            continue;
+        }
+
+        if (opened || file->getDocType() == DocType::Unknown) {
+            openFile(file, p_mode, p_forceMode);
+            continue;
+        }
+
+        if (curWindowIndex == -1) {
+            insertSplitWindow(0);
+            curWindowIndex = 0;
+        }
+
+        getWindow(curWindowIndex)->openFileDeferred(file);
+    }
+
+    if (lastFile) {
+        openFile(lastFile, p_mode, p_forceMode);
+    }
+}
+
 void VEditArea::registerCaptainTargets()
 {
     using namespace std::placeholders;
@@ -10,6 +10,7 @@
 #include <QPair>
 #include <QSplitter>
 #include <QStack>
+#include <QHash>
 #include "vnotebook.h"
 #include "veditwindow.h"
 #include "vnavigationmode.h"
@@ -57,6 +58,17 @@ public:
     // If fail, just delete the p_widget.
     void moveTab(QWidget *p_widget, int p_fromIdx, int p_toIdx);
 
+    // Record @p_tab in the file-to-tab index shared by all the windows.
+    // Called by VEditWindow when a tab is inserted into it.
+    void registerEditTab(VEditTab *p_tab);
+
+    // Remove @p_tab from the file-to-tab index.
+    // Called by VEditWindow before a tab is removed from it.
+    void unregisterEditTab(VEditTab *p_tab);
+
+    // Return all the tabs in all the windows opening @p_file.
+    QVector<VEditTab *> findEditTabs(const VFile *p_file) const;
+
     VFindReplaceDialog *getFindReplaceDialog() const;
 
     // Return selected text of current edit tab.
@@ -77,6 +89,13 @@ public:
     // Open files @p_files.
     int openFiles(const QVector<VFileSessionInfo> &p_files);
 
+    // Open @p_files in mode @p_mode in one batch.
+    // Only the last one is set up and made current right away. Others opened
+    // in read mode are set up once activated.
+    void openFiles(const QVector<VFile *> &p_files,
+                   OpenFileMode p_mode,
+                   bool p_forceMode = false);
+
     // Record a closed file in the stack.
     void recordClosedFile(const VFileSessionInfo &p_file);
 
@@ -216,6 +235,13 @@ private:
 
     // Last closed files stack.
     QStack<VFileSessionInfo> m_lastClosedFiles;
+
+    // File to the tabs opening it, across all the windows.
+    QHash<const VFile *, QVector<VEditTab *> > m_fileTabs;
+
+    // Tab to the file it is registered with, used to unregister the tab
+    // even if its file has been deleted.
+    QHash<const VEditTab *, const VFile *> m_tabFiles;
 };
 
 inline VEditWindow* VEditArea::getWindow(int windowIndex) const
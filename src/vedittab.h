@@ -114,6 +114,10 @@ public:
     // Handle the change of file or directory, such as the file has been moved.
     virtual void handleFileOrDirectoryChange(bool p_isFile, UpdateAction p_act);
 
+    // Set up the content of a tab opened deferred.
+    // Called when the tab becomes current.
+    virtual void materialize() {}
+
 public slots:
     // Enter edit mode
     virtual void editFile() = 0;
@@ -20,7 +20,8 @@ VEditWindow::VEditWindow(VEditArea *editArea, QWidget *parent)
     : QTabWidget(parent),
       m_editArea(editArea),
       m_curTabWidget(NULL),
-      m_lastTabWidget(NULL)
+      m_lastTabWidget(NULL),
+      m_batchDepth(0)
 {
     setAcceptDrops(true);
     initTabActions();
@@ -269,8 +270,11 @@ void VEditWindow::removeEditTab(int p_index)
     Q_ASSERT(p_index > -1 && p_index < tabBar()->count());
 
     VEditTab *editor = getTab(p_index);
+    m_editArea->unregisterEditTab(editor);
     removeTab(p_index);
     delete editor;
+
+    updateTabsSequence(p_index);
 }
 
 int VEditWindow::insertEditTab(int p_index, VFile *p_file, QWidget *p_page)
@@ -278,7 +282,9 @@ int VEditWindow::insertEditTab(int p_index, VFile *p_file, QWidget *p_page)
     int idx = insertTab(p_index,
                         p_page,
                         p_file->getName());
+    m_editArea->registerEditTab(getTab(idx));
     updateTabInfo(idx);
+    updateTabsSequence(idx + 1);
     return idx;
 }
 
@@ -303,6 +309,16 @@ out:
     return idx;
 }
 
+int VEditWindow::openFileDeferred(VFile *p_file)
+{
+    int idx = findTabByFile(p_file);
+    if (idx > -1) {
+        return idx;
+    }
+
+    return openFileInTab(p_file, OpenFileMode::Read, true);
+}
+
 // Return true if we closed the file actually
 bool VEditWindow::closeFile(const VFile *p_file, bool p_forced)
 {
@@ -339,45 +355,59 @@ bool VEditWindow::closeFile(const VFile *p_file, bool p_forced)
 bool VEditWindow::closeFile(const VDirectory *p_dir, bool p_forced)
 {
     Q_ASSERT(p_dir);
-    int i = 0;
-    while (i < count()) {
-        VEditTab *editor = getTab(i);
-        QPointer<VFile> file = editor->getFile();
+    QVector<QPointer<VFile> > files;
+    int nrTab = count();
+    for (int i = 0; i < nrTab; ++i) {
+        VFile *file = getTab(i)->getFile();
         if (p_dir->containsFile(file)) {
-            if (!closeFile(file, p_forced)) {
-                return false;
-            }
-            // Closed a file, so don't need to add i.
-        } else {
-            ++i;
+            files.append(file);
         }
     }
-    return true;
+
+    return closeFiles(files, p_forced);
 }
 
 bool VEditWindow::closeFile(const VNotebook *p_notebook, bool p_forced)
 {
     Q_ASSERT(p_notebook);
-    int i = 0;
-    while (i < count()) {
-        VEditTab *editor = getTab(i);
-        QPointer<VFile> file = editor->getFile();
+    QVector<QPointer<VFile> > files;
+    int nrTab = count();
+    for (int i = 0; i < nrTab; ++i) {
+        VFile *file = getTab(i)->getFile();
         if (p_notebook->containsFile(file)) {
-            if (!closeFile(file, p_forced)) {
-                return false;
-            }
-            // Closed a file, so don't need to add i.
-        } else {
-            ++i;
+            files.append(file);
         }
     }
-    return true;
+
+    return closeFiles(files, p_forced);
+}
+
+bool VEditWindow::closeFiles(const QVector<QPointer<VFile> > &p_files, bool p_forced)
+{
+    if (p_files.isEmpty()) {
+        return true;
+    }
+
+    // Hold the sequence update until all the files are closed.
+    ++m_batchDepth;
+    bool ret = true;
+    for (auto const & file : p_files) {
+        if (file && !closeFile(file, p_forced)) {
+            ret = false;
+            break;
+        }
+    }
+
+    --m_batchDepth;
+    updateTabsSequence(0);
+    return ret;
 }
 
 bool VEditWindow::closeAllFiles(bool p_forced)
 {
     int nrTab = count();
     bool ret = true;
+    ++m_batchDepth;
     for (int i = 0; i < nrTab; ++i) {
         VEditTab *editor = getTab(0);
 
@@ -401,6 +431,9 @@ bool VEditWindow::closeAllFiles(bool p_forced)
         }
     }
 
+    --m_batchDepth;
+    updateTabsSequence(0);
+
     if (count() == 0) {
         emit requestRemoveSplit(this);
     }
@@ -408,12 +441,12 @@ bool VEditWindow::closeAllFiles(bool p_forced)
     return ret;
 }
 
-int VEditWindow::openFileInTab(VFile *p_file, OpenFileMode p_mode)
+int VEditWindow::openFileInTab(VFile *p_file, OpenFileMode p_mode, bool p_deferred)
 {
     VEditTab *editor = NULL;
     switch (p_file->getDocType()) {
     case DocType::Markdown:
-        editor = new VMdTab(p_file, m_editArea, p_mode, this);
+        editor = new VMdTab(p_file, m_editArea, p_mode, this, p_deferred);
         break;
 
     case DocType::Html:
@@ -434,12 +467,20 @@ int VEditWindow::openFileInTab(VFile *p_file, OpenFileMode p_mode)
 
 int VEditWindow::findTabByFile(const VFile *p_file) const
 {
-    int nrTabs = count();
-    for (int i = 0; i < nrTabs; ++i) {
-        if (getTab(i)->getFile() == p_file) {
-            return i;
+    if (!p_file) {
+        return -1;
+    }
+
+    // The index may keep a stale tab if a new file is allocated at the address
+    // of a deleted one, so check the file again.
+    const QVector<VEditTab *> tabs = m_editArea->findEditTabs(p_file);
+    for (auto tab : tabs) {
+        int idx = indexOf(tab);
+        if (idx != -1 && tab->getFile() == p_file) {
+            return idx;
         }
     }
+
     return -1;
 }
 
@@ -540,7 +581,16 @@ void VEditWindow::updateTabInfo(int p_index)
 
 void VEditWindow::updateAllTabsSequence()
 {
-    for (int i = 0; i < count(); ++i) {
+    updateTabsSequence(0);
+}
+
+void VEditWindow::updateTabsSequence(int p_from)
+{
+    if (m_batchDepth > 0) {
+        return;
+    }
+
+    for (int i = qMax(p_from, 0); i < count(); ++i) {
         VEditTab *editor = getTab(i);
         setTabText(i, generateTabText(i, editor));
     }
@@ -599,6 +649,11 @@ void VEditWindow::handleCurrentIndexChanged(int p_index)
 
     m_lastTabWidget = m_curTabWidget;
     m_curTabWidget = wid;
+
+    VEditTab *tab = getTab(p_index);
+    if (tab) {
+        tab->materialize();
+    }
 }
 
 void VEditWindow::mousePressEvent(QMouseEvent *event)
@@ -812,15 +867,25 @@ void VEditWindow::updateDirectoryInfo(const VDirectory *p_dir, UpdateAction p_ac
         return;
     }
 
+    // Only the current tab needs to propagate its status.
+    int curIdx = currentIndex();
+    bool curUpdated = false;
     int nrTab = count();
     for (int i = 0; i < nrTab; ++i) {
         VEditTab *editor = getTab(i);
         QPointer<VFile> file = editor->getFile();
         if (p_dir->containsFile(file)) {
-            updateTabStatus(i);
+            updateTabInfo(i);
             editor->handleFileOrDirectoryChange(false, p_act);
+            if (i == curIdx) {
+                curUpdated = true;
+            }
         }
     }
+
+    if (curUpdated) {
+        updateTabStatus(curIdx);
+    }
 }
 
 void VEditWindow::updateNotebookInfo(const VNotebook *p_notebook)
@@ -829,14 +894,23 @@ void VEditWindow::updateNotebookInfo(const VNotebook *p_notebook)
         return;
     }
 
+    int curIdx = currentIndex();
+    bool curUpdated = false;
     int nrTab = count();
     for (int i = 0; i < nrTab; ++i) {
         VEditTab *editor = getTab(i);
         QPointer<VFile> file = editor->getFile();
         if (p_notebook->containsFile(file)) {
-            updateTabStatus(i);
+            updateTabInfo(i);
+            if (i == curIdx) {
+                curUpdated = true;
+            }
         }
     }
+
+    if (curUpdated) {
+        updateTabStatus(curIdx);
+    }
 }
 
 VEditTab *VEditWindow::getCurrentTab() const
@@ -913,7 +987,9 @@ void VEditWindow::moveTabOneSplit(int p_tabIdx, bool p_right)
     VEditTab *editor = getTab(p_tabIdx);
     // Remove it from current window. This won't close the split even if it is
     // the only tab.
+    m_editArea->unregisterEditTab(editor);
     removeTab(p_tabIdx);
+    updateTabsSequence(p_tabIdx);
 
     // Disconnect all the signals.
     disconnect(editor, 0, this, 0);
@@ -1124,7 +1200,10 @@ void VEditWindow::tabRequestToClose(VEditTab *p_tab)
 {
     bool ok = p_tab->closeFile(false);
     if (ok) {
-        removeTab(indexOf(p_tab));
+        m_editArea->unregisterEditTab(p_tab);
+        int idx = indexOf(p_tab);
+        removeTab(idx);
+        updateTabsSequence(idx);
 
         // Disconnect all the signals.
         disconnect(p_tab, 0, this, 0);
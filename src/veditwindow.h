@@ -6,6 +6,8 @@
 #include <QString>
 #include <QFileInfo>
 #include <QDir>
+#include <QPointer>
+#include <QVector>
 #include "vnotebook.h"
 #include "vedittab.h"
 #include "vconstants.h"
@@ -22,6 +24,10 @@ public:
     explicit VEditWindow(VEditArea *editArea, QWidget *parent = 0);
     int findTabByFile(const VFile *p_file) const;
     int openFile(VFile *p_file, OpenFileMode p_mode);
+
+    // Open @p_file in read mode without switching to it.
+    // The tab will be set up once it becomes current.
+    int openFileDeferred(VFile *p_file);
     bool closeFile(const VFile *p_file, bool p_forced);
     bool closeFile(const VDirectory *p_dir, bool p_forced);
     bool closeFile(const VNotebook *p_notebook, bool p_forced);
@@ -151,7 +157,7 @@ private:
     void removeEditTab(int p_index);
     int insertEditTab(int p_index, VFile *p_file, QWidget *p_page);
     int appendEditTab(VFile *p_file, QWidget *p_page);
-    int openFileInTab(VFile *p_file, OpenFileMode p_mode);
+    int openFileInTab(VFile *p_file, OpenFileMode p_mode, bool p_deferred = false);
 
     QString generateTooltip(const VFile *p_file) const;
 
@@ -171,6 +177,13 @@ private:
     // Update the sequence number of all the tabs.
     void updateAllTabsSequence();
 
+    // Update the sequence number of tabs starting from @p_from.
+    // Does nothing within a batch operation.
+    void updateTabsSequence(int p_from);
+
+    // Close @p_files as a batch, updating the tab sequence once.
+    bool closeFiles(const QVector<QPointer<VFile> > &p_files, bool p_forced);
+
     // Connect the signals of VEditTab to this VEditWindow.
     void connectEditTab(const VEditTab *p_tab);
 
@@ -180,6 +193,9 @@ private:
     QWidget *m_curTabWidget;
     QWidget *m_lastTabWidget;
 
+    // Nesting level of batch operations holding the tab sequence update.
+    int m_batchDepth;
+
     // Button in the right corner
     QPushButton *rightBtn;
     // Button in the left corner
@@ -23,6 +23,7 @@
 #include "vmarkdownconverter.h"
 #include "vdocument.h"
 #include "vlineedit.h"
+#include "vpdfmerger.h"
 
 extern VConfigManager *g_config;
 
@@ -63,6 +64,9 @@ void VExporter::setupUI()
     m_layoutLabel = new QLabel();
     m_layoutBtn = new QPushButton(tr("&Settings"));
 
+    m_splitCB = new QCheckBox(tr("Render long note in parts"));
+    m_splitCB->setToolTip(tr("Render a long note section by section into one PDF file to limit the memory usage"));
+
 #ifndef QT_NO_PRINTER
     connect(m_layoutBtn, &QPushButton::clicked,
             this, &VExporter::handleLayoutBtnClicked);
@@ -93,9 +97,10 @@ void VExporter::setupUI()
     mainLayout->addWidget(layoutLabel, 2, 0);
     mainLayout->addWidget(m_layoutLabel, 2, 1);
     mainLayout->addWidget(m_layoutBtn, 2, 2);
-    mainLayout->addWidget(m_proLabel, 3, 1, 1, 2);
-    mainLayout->addWidget(m_proBar, 4, 1, 1, 2);
-    mainLayout->addWidget(m_btnBox, 5, 1, 1, 2);
+    mainLayout->addWidget(m_splitCB, 3, 1, 1, 2);
+    mainLayout->addWidget(m_proLabel, 4, 1, 1, 2);
+    mainLayout->addWidget(m_proBar, 5, 1, 1, 2);
+    mainLayout->addWidget(m_btnBox, 6, 1, 1, 2);
 
     m_proLabel->hide();
     m_proBar->hide();
@@ -109,6 +114,98 @@ void VExporter::setupUI()
     updatePageLayoutLabel();
 }
 
+// Split Markdown @p_text into parts of about @p_size characters.
+// A part ends before a heading, or before a blank line if it grows to twice
+// @p_size without any heading. Fenced code blocks and HTML blocks are never
+// split. Link reference and footnote definitions are appended to each part to
+// keep links and footnotes working. A note with [TOC] is not split since the
+// TOC should cover the whole note.
+static QStringList splitMarkdown(const QString &p_text, int p_size)
+{
+    QStringList parts;
+    if (p_size <= 0
+        || p_text.size() <= p_size
+        || p_text.contains(QRegExp("(^|\\n)\\[toc\\]", Qt::CaseInsensitive))) {
+        parts.append(p_text);
+        return parts;
+    }
+
+    QRegExp headingExp("^\\s{0,3}#{1,6}(\\s|$)");
+    QRegExp refExp("^\\s{0,3}\\[[^\\]]+\\]:");
+    QRegExp footnoteExp("^\\s{0,3}\\[\\^[^\\]]+\\]:");
+    QRegExp htmlExp("^\\s{0,3}<(!--|/?[A-Za-z][A-Za-z0-9-]*)");
+    QStringList rawTags({"pre", "script", "style", "textarea"});
+    QString refs;
+    QString part;
+    bool inCode = false;
+    bool inHtml = false;
+    bool inFootnote = false;
+    // End of current HTML block. Empty to end at a blank line.
+    QString htmlEnd;
+    QStringList lines = p_text.split('\n');
+    for (auto const & line : lines) {
+        QString trimmed = line.trimmed();
+        if (!inCode && !inHtml && part.size() >= p_size) {
+            if (headingExp.indexIn(line) == 0
+                || (part.size() >= 2 * p_size && trimmed.isEmpty())) {
+                parts.append(part);
+                part.clear();
+            }
+        }
+
+        part += line + '\n';
+
+        if (inFootnote) {
+            // Continuation lines of a footnote are indented.
+            if (trimmed.isEmpty() || line.startsWith("    ") || line.startsWith('\t')) {
+                refs += line + '\n';
+                continue;
+            }
+
+            inFootnote = false;
+        }
+
+        if (inHtml) {
+            if (htmlEnd.isEmpty() ? trimmed.isEmpty() : line.contains(htmlEnd, Qt::CaseInsensitive)) {
+                inHtml = false;
+            }
+        } else if (trimmed.startsWith("```") || trimmed.startsWith("~~~")) {
+            inCode = !inCode;
+        } else if (inCode) {
+            continue;
+        } else if (htmlExp.indexIn(line) == 0) {
+            QString tag = htmlExp.cap(1).toLower();
+            if (tag == "!--") {
+                htmlEnd = "-->";
+            } else if (rawTags.contains(tag)) {
+                htmlEnd = "</" + tag + ">";
+            } else {
+                htmlEnd.clear();
+            }
+
+            inHtml = htmlEnd.isEmpty()
+                     || !line.mid(htmlExp.matchedLength()).contains(htmlEnd, Qt::CaseInsensitive);
+        } else if (footnoteExp.indexIn(line) == 0) {
+            refs += line + '\n';
+            inFootnote = true;
+        } else if (refExp.indexIn(line) == 0) {
+            refs += line + '\n';
+        }
+    }
+
+    if (!part.isEmpty()) {
+        parts.append(part);
+    }
+
+    if (!refs.isEmpty() && parts.size() > 1) {
+        for (auto & pa : parts) {
+            pa += '\n' + refs;
+        }
+    }
+
+    return parts;
+}
+
 static QString exportTypeStr(ExportType p_type)
 {
     if (p_type == ExportType::PDF) {
@@ -191,11 +288,13 @@ void VExporter::exportNote(VFile *p_file, ExportType p_type)
 
     setWindowTitle(tr("Export As %1").arg(exportTypeStr(p_type)));
 
+    m_splitCB->setVisible(p_type == ExportType::PDF);
+
     setFilePath(QDir(s_defaultPathDir).filePath(QFileInfo(p_file->fetchPath()).baseName() +
                                                 "." + exportTypeStr(p_type).toLower()));
 }
 
-void VExporter::initWebViewer(VFile *p_file)
+void VExporter::initWebViewer(VFile *p_file, const QString &p_content)
 {
     V_ASSERT(!m_webViewer);
 
@@ -207,7 +306,8 @@ void VExporter::initWebViewer(VFile *p_file)
     connect(page, &VPreviewPage::loadFinished,
             this, &VExporter::handleLoadFinished);
 
-    VDocument *document = new VDocument(p_file, m_webViewer);
+    VDocument *document = new VDocument(p_content.isNull() ? p_file : NULL, m_webViewer);
+    document->setContent(p_content);
     connect(document, &VDocument::logicsFinished,
             this, &VExporter::handleLogicsFinished);
 
@@ -219,7 +319,7 @@ void VExporter::initWebViewer(VFile *p_file)
     if (m_mdType == MarkdownConverterType::Hoedown) {
         VMarkdownConverter mdConverter;
         QString toc;
-        QString html = mdConverter.generateHtml(p_file->getContent(),
+        QString html = mdConverter.generateHtml(p_content.isNull() ? p_file->getContent() : p_content,
                                                 g_config->getMarkdownExtensions(),
                                                 toc);
         document->setHtml(html);
@@ -291,11 +391,12 @@ void VExporter::startExport()
             goto exit;
         }
 
-        clearNoteState();
-        initWebViewer(m_file);
+        QStringList parts;
+        if (m_type == ExportType::PDF && m_splitCB->isChecked()) {
+            parts = splitMarkdown(m_file->getContent(),
+                                  g_config->getPdfExportPartSize() * 1024);
+        }
 
-        // Update progress info.
-        m_proLabel->setText(tr("Exporting %1").arg(m_file->getName()));
         m_proBar->setEnabled(true);
         m_proBar->setMinimum(0);
         m_proBar->setMaximum(100);
@@ -303,39 +404,47 @@ void VExporter::startExport()
         m_proLabel->show();
         m_proBar->show();
 
-        while (!isNoteStateReady()) {
-            VUtils::sleepWait(100);
-            if (m_proBar->value() < 70) {
-                m_proBar->setValue(m_proBar->value() + 1);
+        bool exportRet = true;
+        if (parts.size() <= 1) {
+            m_proLabel->setText(tr("Exporting %1").arg(m_file->getName()));
+            exportRet = exportPartToPDF(QString(), NULL, 0, 100);
+        } else {
+            // Render each part and append its pages to the target file.
+            VPdfMerger merger(getFilePath());
+            exportRet = merger.open();
+            for (int i = 0; exportRet && i < parts.size(); ++i) {
+                m_proLabel->setText(tr("Exporting %1 (%2/%3)").arg(m_file->getName())
+                                                             .arg(i + 1)
+                                                             .arg(parts.size()));
+                exportRet = exportPartToPDF(parts[i],
+                                            &merger,
+                                            i * 100 / parts.size(),
+                                            (i + 1) * 100 / parts.size());
             }
 
-            if (m_state == ExportState::Cancelled) {
-                goto exit;
+            if (exportRet) {
+                exportRet = merger.finish();
             }
 
-            if (isNoteStateFailed()) {
-                m_state = ExportState::Failed;
-                goto exit;
+            if (!exportRet && !merger.errorString().isEmpty()) {
+                VUtils::showMessage(QMessageBox::Warning,
+                                    tr("Warning"),
+                                    tr("Fail to export note %1.").arg(m_file->getName()),
+                                    merger.errorString(),
+                                    QMessageBox::Ok,
+                                    QMessageBox::Ok,
+                                    this);
             }
         }
 
-        // Wait to ensure Web side is really ready.
-        VUtils::sleepWait(200);
-
-        if (m_state == ExportState::Cancelled) {
-            goto exit;
-        }
-
-        m_proBar->setValue(80);
-
-        bool exportRet = exportToPDF(m_webViewer, getFilePath(), m_pageLayout);
-
-        clearNoteState();
-
         if (!isOpened) {
             m_file->close();
         }
 
+        if (m_state == ExportState::Cancelled || m_state == ExportState::Failed) {
+            goto exit;
+        }
+
         if (exportRet) {
             m_proBar->setValue(100);
             m_state = ExportState::Successful;
@@ -375,8 +484,56 @@ void VExporter::cancelExport()
     }
 }
 
+bool VExporter::exportPartToPDF(const QString &p_content,
+                                VPdfMerger *p_merger,
+                                int p_proStart,
+                                int p_proEnd)
+{
+    clearNoteState();
+    initWebViewer(m_file, p_content);
+
+    bool ret = false;
+    int waitEnd = p_proStart + (p_proEnd - p_proStart) * 7 / 10;
+    while (!isNoteStateReady()) {
+        VUtils::sleepWait(100);
+        if (m_proBar->value() < waitEnd) {
+            m_proBar->setValue(m_proBar->value() + 1);
+        }
+
+        if (m_state == ExportState::Cancelled) {
+            break;
+        }
+
+        if (isNoteStateFailed()) {
+            m_state = ExportState::Failed;
+            break;
+        }
+    }
+
+    if (isNoteStateReady()) {
+        // Wait to ensure Web side is really ready.
+        VUtils::sleepWait(200);
+
+        if (m_state != ExportState::Cancelled) {
+            m_proBar->setValue(p_proStart + (p_proEnd - p_proStart) * 8 / 10);
+
+            ret = exportToPDF(m_webViewer, getFilePath(), m_pageLayout, p_merger);
+            if (ret) {
+                m_proBar->setValue(p_proEnd);
+            }
+        }
+    }
+
+    clearNoteState();
+
+    // Release the page of this part before rendering the next one.
+    clearWebViewer();
+
+    return ret;
+}
+
 bool VExporter::exportToPDF(VWebView *p_webViewer, const QString &p_filePath,
-                            const QPageLayout &p_layout)
+                            const QPageLayout &p_layout, VPdfMerger *p_merger)
 {
     int pdfPrinted = 0;
     p_webViewer->page()->printToPdf([&, this](const QByteArray &p_result) {
@@ -385,6 +542,11 @@ bool VExporter::exportToPDF(VWebView *p_webViewer, const QString &p_filePath,
             return;
         }
 
+        if (p_merger) {
+            pdfPrinted = p_merger->append(p_result) ? 1 : -1;
+            return;
+        }
+
         V_ASSERT(!p_filePath.isEmpty());
 
         QFile file(p_filePath);
@@ -417,6 +579,7 @@ void VExporter::enableUserInput(bool p_enabled)
     m_pathEdit->setEnabled(p_enabled);
     m_browseBtn->setEnabled(p_enabled);
     m_layoutBtn->setEnabled(p_enabled);
+    m_splitCB->setEnabled(p_enabled);
 }
 
 void VExporter::openTargetPath() const
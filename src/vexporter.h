@@ -9,10 +9,12 @@
 class VWebView;
 class VFile;
 class VLineEdit;
+class VPdfMerger;
 class QLabel;
 class QDialogButtonBox;
 class QPushButton;
 class QProgressBar;
+class QCheckBox;
 
 enum class ExportType
 {
@@ -74,13 +76,26 @@ private:
 
     QString getFilePath() const;
 
-    void initWebViewer(VFile *p_file);
+    // @p_content: Markdown to render instead of the content of @p_file if not null.
+    void initWebViewer(VFile *p_file, const QString &p_content = QString());
 
     void clearWebViewer();
 
     void enableUserInput(bool p_enabled);
 
-    bool exportToPDF(VWebView *p_webViewer, const QString &p_filePath, const QPageLayout &p_layout);
+    // Append the PDF to @p_merger instead of writing @p_filePath if not NULL.
+    bool exportToPDF(VWebView *p_webViewer,
+                     const QString &p_filePath,
+                     const QPageLayout &p_layout,
+                     VPdfMerger *p_merger = NULL);
+
+    // Render @p_content (the whole note if null) and export it as PDF to the
+    // target file, or append it to @p_merger if not NULL.
+    // The progress bar advances from @p_proStart to @p_proEnd.
+    bool exportPartToPDF(const QString &p_content,
+                         VPdfMerger *p_merger,
+                         int p_proStart,
+                         int p_proEnd);
 
     void clearNoteState();
     bool isNoteStateReady() const;
@@ -103,6 +118,9 @@ private:
     QPushButton *m_browseBtn;
     QLabel *m_layoutLabel;
     QPushButton *m_layoutBtn;
+
+    // Whether render a long note section by section when exporting it to PDF.
+    QCheckBox *m_splitCB;
     QDialogButtonBox *m_btnBox;
     QPushButton *m_openBtn;
 
@@ -0,0 +1,86 @@
+#include "vimagesaver.h"
+
+#include <QThreadPool>
+#include <QFileInfo>
+#include <QByteArray>
+#include <QBuffer>
+#include <QFile>
+#include <QDebug>
+
+#include "utils/vutils.h"
+#include "vconfigmanager.h"
+#include "vimagestore.h"
+
+extern VConfigManager *g_config;
+
+VImageSaver::VImageSaver(const QImage &p_image,
+                         const QString &p_folderPath,
+                         const QString &p_filePath,
+                         QObject *p_parent)
+    : QObject(p_parent),
+      QRunnable(),
+      m_image(p_image),
+      m_folderPath(p_folderPath),
+      m_filePath(p_filePath),
+      m_computeHash(false)
+{
+    // Deleted via deleteLater() in the thread of this object.
+    setAutoDelete(false);
+}
+
+void VImageSaver::setComputeHash(bool p_enabled)
+{
+    m_computeHash = p_enabled;
+}
+
+void VImageSaver::start()
+{
+    QThreadPool::globalInstance()->start(this);
+}
+
+void VImageSaver::run()
+{
+    QString errStr;
+    QByteArray hash;
+    bool ret = VUtils::makePath(m_folderPath);
+    if (!ret) {
+        errStr = tr("Fail to create image folder <span style=\"%1\">%2</span>.")
+                   .arg(g_config->c_dataTextStyle).arg(m_folderPath);
+    } else {
+        // Encode in memory first so a failure will not leave a partial file.
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        QByteArray format = QFileInfo(m_filePath).suffix().toLatin1();
+        ret = m_image.save(&buffer, format.isEmpty() ? "png" : format.constData());
+        buffer.close();
+
+        if (ret && m_computeHash) {
+            hash = VImageStore::hashData(data);
+        }
+
+        if (ret) {
+            QFile file(m_filePath);
+            ret = file.open(QIODevice::WriteOnly)
+                  && file.write(data) == data.size();
+            file.close();
+            if (!ret) {
+                file.remove();
+            }
+        }
+
+        if (!ret) {
+            errStr = tr("Fail to save image <span style=\"%1\">%2</span>.")
+                       .arg(g_config->c_dataTextStyle).arg(m_filePath);
+        }
+    }
+
+    // Release the image as soon as possible.
+    m_image = QImage();
+
+    qDebug() << "image saver finished" << ret << m_filePath;
+
+    emit finished(ret, m_filePath, errStr, hash);
+
+    deleteLater();
+}
@@ -0,0 +1,51 @@
+#ifndef VIMAGESAVER_H
+#define VIMAGESAVER_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QImage>
+#include <QString>
+#include <QByteArray>
+
+// Encode an image and write it to disk in a worker thread.
+// It will delete itself after finished() is emitted.
+class VImageSaver : public QObject, public QRunnable
+{
+    Q_OBJECT
+public:
+    // @p_folderPath: the folder to write the image into, will be created
+    // if not exists;
+    // @p_filePath: the path of the image file.
+    VImageSaver(const QImage &p_image,
+                const QString &p_folderPath,
+                const QString &p_filePath,
+                QObject *p_parent = nullptr);
+
+    // Whether compute the hash of the encoded image data.
+    void setComputeHash(bool p_enabled);
+
+    // Start the saving in the global thread pool.
+    void start();
+
+    void run() Q_DECL_OVERRIDE;
+
+signals:
+    // Emitted in the worker thread. Use queued connection to receive it.
+    // @p_errStr: error message if failed.
+    // @p_hash: hash of the image data if required.
+    void finished(bool p_succeed,
+                  const QString &p_filePath,
+                  const QString &p_errStr,
+                  const QByteArray &p_hash);
+
+private:
+    QImage m_image;
+
+    QString m_folderPath;
+
+    QString m_filePath;
+
+    bool m_computeHash;
+};
+
+#endif // VIMAGESAVER_H
@@ -0,0 +1,679 @@
+#include "vimagestore.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QCryptographicHash>
+#include <QDebug>
+
+#include "vfile.h"
+#include "vnotefile.h"
+#include "vnotebook.h"
+
+const QString VImageStore::c_indexFile = "_v_image_store.json";
+
+VImageStore::VImageStore(const VNotebook *p_notebook)
+    : m_notebook(p_notebook),
+      m_notebookPath(p_notebook->getPath()),
+      m_loaded(false),
+      m_dirty(false)
+{
+}
+
+VImageStore::~VImageStore()
+{
+    flush();
+}
+
+void VImageStore::load()
+{
+    if (m_loaded) {
+        return;
+    }
+
+    m_loaded = true;
+
+    QString indexPath = QDir(m_notebookPath).filePath(c_indexFile);
+    if (!QFileInfo::exists(indexPath)) {
+        return;
+    }
+
+    // Index written without references needs a rebuild.
+    bool hasReferences = true;
+    QJsonObject json = VUtils::readJsonFromDisk(indexPath);
+    QJsonArray arr = json["images"].toArray();
+    for (int i = 0; i < arr.size(); ++i) {
+        QJsonObject obj = arr[i].toObject();
+        QByteArray hash = obj["hash"].toString().toLatin1();
+        QString path = obj["path"].toString();
+        if (hash.isEmpty() || path.isEmpty()) {
+            continue;
+        }
+
+        QString key = pathKey(path);
+        m_images.insert(hash, path);
+        m_pathToHash.insert(key, hash);
+
+        if (!obj.contains("refs")) {
+            hasReferences = false;
+            continue;
+        }
+
+        QJsonArray refs = obj["refs"].toArray();
+        for (int j = 0; j < refs.size(); ++j) {
+            QString noteKey = refs[j].toString();
+            if (!noteKey.isEmpty()) {
+                m_references[key].insert(noteKey);
+                m_noteImages[noteKey].insert(key);
+            }
+        }
+    }
+
+    qDebug() << "image store loaded" << m_images.size() << "images" << m_notebookPath;
+
+    if (!hasReferences) {
+        rebuild();
+    }
+}
+
+bool VImageStore::save() const
+{
+    QJsonArray arr;
+    for (auto it = m_images.constBegin(); it != m_images.constEnd(); ++it) {
+        QJsonObject obj;
+        obj["hash"] = QString::fromLatin1(it.key());
+        obj["path"] = it.value();
+
+        QStringList refs = m_references.value(pathKey(it.value())).toList();
+        refs.sort();
+        obj["refs"] = QJsonArray::fromStringList(refs);
+        arr.append(obj);
+    }
+
+    QJsonObject json;
+    json["images"] = arr;
+
+    QString indexPath = QDir(m_notebookPath).filePath(c_indexFile);
+    if (!VUtils::writeJsonToDisk(indexPath, json)) {
+        qWarning() << "fail to write image store index" << indexPath;
+        return false;
+    }
+
+    return true;
+}
+
+void VImageStore::flush()
+{
+    if (m_dirty && save()) {
+        m_dirty = false;
+    }
+}
+
+void VImageStore::reload()
+{
+    flush();
+
+    m_images.clear();
+    m_pathToHash.clear();
+    m_references.clear();
+    m_noteImages.clear();
+    m_loaded = false;
+
+    load();
+    rebuild();
+    flush();
+}
+
+QString VImageStore::pathKey(const QString &p_path) const
+{
+    QString key = QDir(m_notebookPath).relativeFilePath(QDir::cleanPath(p_path));
+    key = QDir::cleanPath(key);
+
+#if defined(Q_OS_WIN) || defined(Q_OS_MACOS) || defined(Q_OS_MAC)
+    key = key.toLower();
+#endif
+
+    return key;
+}
+
+QString VImageStore::keyPath(const QString &p_key) const
+{
+    return QDir::cleanPath(QDir(m_notebookPath).filePath(p_key));
+}
+
+bool VImageStore::isExcluded(const QString &p_key, const QString &p_excludedKey)
+{
+    if (p_excludedKey.isEmpty()) {
+        return false;
+    }
+
+    // The root folder of the notebook.
+    if (p_excludedKey == ".") {
+        return true;
+    }
+
+    return p_key == p_excludedKey
+           || p_key.startsWith(p_excludedKey + "/");
+}
+
+void VImageStore::setNoteImages(const QString &p_noteKey, const QSet<QString> &p_imageKeys)
+{
+    // Images taken by the note are now referred on disk.
+    for (auto const & key : p_imageKeys) {
+        auto pinIt = m_pins.find(key);
+        if (pinIt != m_pins.end()) {
+            pinIt.value().remove(p_noteKey);
+            if (pinIt.value().isEmpty()) {
+                m_pins.erase(pinIt);
+            }
+        }
+    }
+
+    QSet<QString> oldKeys = m_noteImages.value(p_noteKey);
+    if (oldKeys == p_imageKeys) {
+        return;
+    }
+
+    for (auto const & key : oldKeys) {
+        if (p_imageKeys.contains(key)) {
+            continue;
+        }
+
+        auto refIt = m_references.find(key);
+        if (refIt != m_references.end()) {
+            refIt.value().remove(p_noteKey);
+            if (refIt.value().isEmpty()) {
+                m_references.erase(refIt);
+            }
+        }
+    }
+
+    for (auto const & key : p_imageKeys) {
+        m_references[key].insert(p_noteKey);
+    }
+
+    if (p_imageKeys.isEmpty()) {
+        m_noteImages.remove(p_noteKey);
+    } else {
+        m_noteImages.insert(p_noteKey, p_imageKeys);
+    }
+
+    m_dirty = true;
+}
+
+QSet<QString> VImageStore::fetchNoteImages(const QString &p_notePath)
+{
+    QSet<QString> keys;
+    QString text = VUtils::readFileFromDisk(p_notePath);
+    QVector<ImageLink> images = VUtils::fetchImagesFromMarkdownText(text,
+                                                                    VUtils::basePathFromPath(p_notePath),
+                                                                    NULL,
+                                                                    ImageLink::LocalRelativeExternal);
+    for (auto const & link : images) {
+        QString key = pathKey(link.m_path);
+        if (m_pathToHash.contains(key)) {
+            keys.insert(key);
+        }
+    }
+
+    return keys;
+}
+
+void VImageStore::removeImage(const QString &p_key)
+{
+    m_images.remove(m_pathToHash.take(p_key));
+
+    QSet<QString> notes = m_references.take(p_key);
+    for (auto const & noteKey : notes) {
+        auto noteIt = m_noteImages.find(noteKey);
+        if (noteIt != m_noteImages.end()) {
+            noteIt.value().remove(p_key);
+            if (noteIt.value().isEmpty()) {
+                m_noteImages.erase(noteIt);
+            }
+        }
+    }
+
+    m_pins.remove(p_key);
+    m_dirty = true;
+}
+
+void VImageStore::rebuild()
+{
+    qDebug() << "rebuild image store references" << m_notebookPath;
+
+    m_references.clear();
+    m_noteImages.clear();
+    m_dirty = true;
+
+    scanReferences(m_notebookPath);
+}
+
+void VImageStore::scanReferences(const QString &p_path)
+{
+    load();
+
+    if (m_images.isEmpty()) {
+        return;
+    }
+
+    QFileInfo info(p_path);
+    if (info.isFile()) {
+        if (VUtils::docTypeFromName(p_path) == DocType::Markdown) {
+            setNoteImages(pathKey(p_path), fetchNoteImages(p_path));
+        }
+
+        return;
+    }
+
+    QString recycleBinKey = pathKey(m_notebook->getRecycleBinFolderPath());
+    QSet<QString> existingNotes;
+    QDirIterator it(p_path, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QString notePath = it.next();
+        if (VUtils::docTypeFromName(notePath) != DocType::Markdown) {
+            continue;
+        }
+
+        QString key = pathKey(notePath);
+        if (isExcluded(key, recycleBinKey)) {
+            continue;
+        }
+
+        existingNotes.insert(key);
+        setNoteImages(key, fetchNoteImages(notePath));
+    }
+
+    // Drop notes removed outside.
+    QString dirKey = pathKey(p_path);
+    QVector<QString> removedNotes;
+    for (auto it = m_noteImages.constBegin(); it != m_noteImages.constEnd(); ++it) {
+        if (isExcluded(it.key(), dirKey) && !existingNotes.contains(it.key())) {
+            removedNotes.append(it.key());
+        }
+    }
+
+    for (auto const & key : removedNotes) {
+        setNoteImages(key, QSet<QString>());
+    }
+}
+
+void VImageStore::checkReferences(const QString &p_key)
+{
+    auto it = m_references.constFind(p_key);
+    if (it == m_references.constEnd()) {
+        return;
+    }
+
+    for (auto const & noteKey : it.value()) {
+        if (!QFileInfo::exists(keyPath(noteKey))) {
+            qDebug() << "image store references missing note" << noteKey;
+            rebuild();
+            return;
+        }
+    }
+}
+
+QString VImageStore::findImage(const QByteArray &p_hash)
+{
+    load();
+
+    auto it = m_images.find(p_hash);
+    if (it == m_images.end()) {
+        return QString();
+    }
+
+    QString path = keyPath(it.value());
+    if (!QFileInfo::exists(path)) {
+        // Removed outside.
+        removeImage(pathKey(path));
+        return QString();
+    }
+
+    return path;
+}
+
+void VImageStore::addImage(const QByteArray &p_hash, const QString &p_path)
+{
+    load();
+
+    auto it = m_images.find(p_hash);
+    if (it != m_images.end()) {
+        removeImage(pathKey(it.value()));
+    }
+
+    m_images.insert(p_hash, QDir(m_notebookPath).relativeFilePath(QDir::cleanPath(p_path)));
+    m_pathToHash.insert(pathKey(p_path), p_hash);
+    m_dirty = true;
+}
+
+void VImageStore::refImage(const QString &p_path, const QString &p_notePath)
+{
+    m_pins[pathKey(p_path)].insert(pathKey(p_notePath));
+}
+
+void VImageStore::addReference(const QString &p_path, const QString &p_notePath)
+{
+    load();
+
+    QString key = pathKey(p_path);
+    if (!m_pathToHash.contains(key)) {
+        return;
+    }
+
+    QString noteKey = pathKey(p_notePath);
+    QSet<QString> keys = m_noteImages.value(noteKey);
+    keys.insert(key);
+    setNoteImages(noteKey, keys);
+}
+
+void VImageStore::updateReferences(const QString &p_notePath, const QVector<ImageLink> &p_images)
+{
+    load();
+
+    QSet<QString> keys;
+    for (auto const & link : p_images) {
+        QString key = pathKey(link.m_path);
+        if (m_pathToHash.contains(key)) {
+            keys.insert(key);
+        }
+    }
+
+    setNoteImages(pathKey(p_notePath), keys);
+}
+
+void VImageStore::removeReferences(const QString &p_path)
+{
+    load();
+
+    QString key = pathKey(p_path);
+    QVector<QString> notes;
+    for (auto it = m_noteImages.constBegin(); it != m_noteImages.constEnd(); ++it) {
+        if (isExcluded(it.key(), key)) {
+            notes.append(it.key());
+        }
+    }
+
+    for (auto const & noteKey : notes) {
+        setNoteImages(noteKey, QSet<QString>());
+    }
+
+    QVector<QString> images;
+    for (auto it = m_pathToHash.constBegin(); it != m_pathToHash.constEnd(); ++it) {
+        if (isExcluded(it.key(), key)) {
+            images.append(it.key());
+        }
+    }
+
+    for (auto const & imageKey : images) {
+        removeImage(imageKey);
+    }
+}
+
+void VImageStore::renamePath(const QString &p_path, const QString &p_newPath)
+{
+    load();
+
+    QString oldKey = pathKey(p_path);
+    QString newKey = pathKey(p_newPath);
+    if (oldKey == newKey) {
+        return;
+    }
+
+    auto mapKey = [&oldKey, &newKey](const QString &p_key) -> QString {
+        if (isExcluded(p_key, oldKey)) {
+            return newKey + p_key.mid(oldKey.size());
+        }
+
+        return p_key;
+    };
+
+    auto mapKeys = [&mapKey](const QHash<QString, QSet<QString>> &p_hash) {
+        QHash<QString, QSet<QString>> ret;
+        for (auto it = p_hash.constBegin(); it != p_hash.constEnd(); ++it) {
+            QSet<QString> &keys = ret[mapKey(it.key())];
+            for (auto const & key : it.value()) {
+                keys.insert(mapKey(key));
+            }
+        }
+
+        return ret;
+    };
+
+    QString newRelPath = QDir(m_notebookPath).relativeFilePath(QDir::cleanPath(p_newPath));
+    QHash<QString, QByteArray> pathToHash;
+    for (auto it = m_pathToHash.constBegin(); it != m_pathToHash.constEnd(); ++it) {
+        if (isExcluded(it.key(), oldKey)) {
+            QString &relPath = m_images[it.value()];
+            relPath = newRelPath + relPath.mid(oldKey.size());
+        }
+
+        pathToHash.insert(mapKey(it.key()), it.value());
+    }
+
+    m_pathToHash = pathToHash;
+    m_references = mapKeys(m_references);
+    m_noteImages = mapKeys(m_noteImages);
+    m_pins = mapKeys(m_pins);
+    m_dirty = true;
+}
+
+bool VImageStore::contains(const QString &p_path)
+{
+    load();
+
+    return m_pathToHash.contains(pathKey(p_path));
+}
+
+bool VImageStore::isReferred(const QString &p_key, const QString &p_noteKey)
+{
+    checkReferences(p_key);
+
+    const QHash<QString, QSet<QString>> *maps[] = { &m_references, &m_pins };
+    for (auto map : maps) {
+        auto it = map->constFind(p_key);
+        if (it == map->constEnd()) {
+            continue;
+        }
+
+        for (auto const & noteKey : it.value()) {
+            if (noteKey != p_noteKey) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool VImageStore::isShared(const QString &p_path, const QString &p_notePath)
+{
+    if (!contains(p_path)) {
+        return false;
+    }
+
+    return isReferred(pathKey(p_path), pathKey(p_notePath));
+}
+
+bool VImageStore::releaseImage(const QString &p_path, const QString &p_notePath)
+{
+    load();
+
+    QString key = pathKey(p_path);
+    if (!m_pathToHash.contains(key)) {
+        return true;
+    }
+
+    QString noteKey = pathKey(p_notePath);
+    auto pinIt = m_pins.find(key);
+    if (pinIt != m_pins.end()) {
+        pinIt.value().remove(noteKey);
+        if (pinIt.value().isEmpty()) {
+            m_pins.erase(pinIt);
+        }
+    }
+
+    QSet<QString> keys = m_noteImages.value(noteKey);
+    if (keys.remove(key)) {
+        setNoteImages(noteKey, keys);
+    }
+
+    if (isReferred(key, noteKey)) {
+        qDebug() << "image still referred" << p_path;
+        return false;
+    }
+
+    removeImage(key);
+    return true;
+}
+
+void VImageStore::moveImage(const QString &p_path, const QString &p_newPath)
+{
+    if (!contains(p_path)) {
+        return;
+    }
+
+    renamePath(p_path, p_newPath);
+}
+
+bool VImageStore::releaseFolder(const QString &p_dirPath, QString *p_errMsg)
+{
+    load();
+
+    bool ret = true;
+    QString dirKey = pathKey(p_dirPath);
+    QVector<QString> images;
+    for (auto it = m_pathToHash.constBegin(); it != m_pathToHash.constEnd(); ++it) {
+        if (isExcluded(it.key(), dirKey)) {
+            images.append(it.key());
+        }
+    }
+
+    // Check before dropping the notes within the folder, which are still on disk.
+    for (auto const & key : images) {
+        checkReferences(key);
+    }
+
+    QVector<QString> notes;
+    for (auto it = m_noteImages.constBegin(); it != m_noteImages.constEnd(); ++it) {
+        if (isExcluded(it.key(), dirKey)) {
+            notes.append(it.key());
+        }
+    }
+
+    for (auto const & noteKey : notes) {
+        setNoteImages(noteKey, QSet<QString>());
+    }
+
+    for (auto const & key : images) {
+        QStringList refs = m_references.value(key).toList();
+        if (refs.isEmpty()) {
+            removeImage(key);
+            continue;
+        }
+
+        refs.sort();
+
+        // Move it to the image folder of the first note.
+        QString path = keyPath(m_images.value(m_pathToHash.value(key)));
+        QString firstNotePath = keyPath(refs[0]);
+        QString folderPath = QDir(VUtils::basePathFromPath(firstNotePath)).filePath(m_notebook->getImageFolder());
+        QString newPath = QDir(folderPath).filePath(VUtils::generateCopiedFileName(folderPath,
+                                                                                    VUtils::fileNameFromPath(path)));
+        if (!VUtils::copyFile(path, newPath, true)) {
+            VUtils::addErrMsg(p_errMsg, QObject::tr("Fail to move image %1 which is still used by other notes.")
+                                          .arg(path));
+            ret = false;
+            continue;
+        }
+
+        moveImage(path, newPath);
+
+        // Update the links.
+        for (auto const & noteKey : refs) {
+            QString notePath = keyPath(noteKey);
+            QString text = VUtils::readFileFromDisk(notePath);
+            QString basePath = VUtils::basePathFromPath(notePath);
+            QVector<ImageLink> links = VUtils::fetchImagesFromMarkdownText(text,
+                                                                           basePath,
+                                                                           NULL,
+                                                                           ImageLink::LocalRelativeExternal);
+            QHash<QString, QString> urls;
+            for (auto const & link : links) {
+                if (pathKey(link.m_path) == key) {
+                    urls.insert(link.m_url, QDir(basePath).relativeFilePath(newPath));
+                }
+            }
+
+            if (urls.isEmpty()) {
+                continue;
+            }
+
+            if (!VUtils::writeFileToDisk(notePath, VUtils::replaceImageUrlsInMarkdown(text, urls))) {
+                VUtils::addErrMsg(p_errMsg, QObject::tr("Fail to update image links in note %1.")
+                                              .arg(notePath));
+                ret = false;
+            }
+        }
+
+        qDebug() << "relocate shared image" << path << "to" << newPath;
+    }
+
+    return ret;
+}
+
+VImageStore *VImageStore::fromFile(const VFile *p_file)
+{
+    if (!p_file || p_file->getType() != FileType::Note) {
+        return NULL;
+    }
+
+    const VNoteFile *file = dynamic_cast<const VNoteFile *>(p_file);
+    Q_ASSERT(file);
+    return file->getNotebook()->getImageStore();
+}
+
+QVector<ImageLink> VImageStore::fetchImagesToCleanUp(VFile *p_file, VImageStore *p_store)
+{
+    if (!p_store) {
+        return VUtils::fetchImagesFromMarkdownFile(p_file,
+                                                   ImageLink::LocalRelativeInternal);
+    }
+
+    ImageLink::ImageLinkType type = (ImageLink::ImageLinkType)(ImageLink::LocalRelativeInternal
+                                                               | ImageLink::LocalRelativeExternal);
+    QVector<ImageLink> images = VUtils::fetchImagesFromMarkdownFile(p_file, type);
+    QVector<ImageLink> ret;
+    ret.reserve(images.size());
+    for (auto const & link : images) {
+        if (link.m_type == ImageLink::LocalRelativeInternal
+            || p_store->contains(link.m_path)) {
+            ret.append(link);
+        }
+    }
+
+    return ret;
+}
+
+QByteArray VImageStore::hashData(const QByteArray &p_data)
+{
+    return QCryptographicHash::hash(p_data, QCryptographicHash::Sha1).toHex();
+}
+
+QByteArray VImageStore::hashFile(const QString &p_path)
+{
+    QFile file(p_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (!hash.addData(&file)) {
+        return QByteArray();
+    }
+
+    return hash.result().toHex();
+}
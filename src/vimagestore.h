@@ -0,0 +1,160 @@
+#ifndef VIMAGESTORE_H
+#define VIMAGESTORE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+#include "utils/vutils.h"
+
+class VFile;
+class VNotebook;
+
+// Content-addressed index of the images within a notebook.
+// Images with identical bytes are stored only once and shared by notes.
+// The index is persisted in the root folder of the notebook together with the
+// notes referring to each image, and is kept up to date by the operations on
+// notes, so deciding whether an image is still used needs no scan of the
+// notebook. The references are rebuilt from the notes on disk only when the
+// index is reloaded explicitly or found inconsistent.
+class VImageStore
+{
+public:
+    explicit VImageStore(const VNotebook *p_notebook);
+
+    ~VImageStore();
+
+    // Return the path of an existing image with hash @p_hash.
+    // Return empty if there is no such image or it has been removed.
+    QString findImage(const QByteArray &p_hash);
+
+    // Add a newly written image @p_path with hash @p_hash.
+    void addImage(const QByteArray &p_hash, const QString &p_path);
+
+    // Note @p_notePath starts to use image @p_path without being saved.
+    // It is kept in this session until the note saves or releases it.
+    void refImage(const QString &p_path, const QString &p_notePath);
+
+    // Note @p_notePath on disk refers to image @p_path.
+    void addReference(const QString &p_path, const QString &p_notePath);
+
+    // Note @p_notePath has been saved with image links @p_images.
+    void updateReferences(const QString &p_notePath, const QVector<ImageLink> &p_images);
+
+    // Update references of note @p_path or notes under folder @p_path from disk.
+    void scanReferences(const QString &p_path);
+
+    // Note or folder @p_path has been removed from the notebook.
+    // Forget references of notes and images under it.
+    void removeReferences(const QString &p_path);
+
+    // Note or folder @p_path has been moved to @p_newPath within the notebook.
+    void renamePath(const QString &p_path, const QString &p_newPath);
+
+    // Whether @p_path is managed by the store.
+    bool contains(const QString &p_path);
+
+    // Whether @p_path is managed by the store and used by notes other than
+    // @p_notePath.
+    bool isShared(const QString &p_path, const QString &p_notePath);
+
+    // Note @p_notePath does not use image @p_path any more.
+    // Return true if @p_path could be deleted, which means it is not managed
+    // by the store or no other note refers to it.
+    bool releaseImage(const QString &p_path, const QString &p_notePath);
+
+    // Image @p_path has been moved to @p_newPath.
+    void moveImage(const QString &p_path, const QString &p_newPath);
+
+    // Folder @p_dirPath is about to be deleted. Forget managed images within it
+    // and move those still used by notes outside the folder next to the first
+    // of these notes, updating the links of all of them.
+    // Return false if any image fails to be relocated.
+    bool releaseFolder(const QString &p_dirPath, QString *p_errMsg = NULL);
+
+    // Drop the index in memory. It will be read from disk and the references
+    // will be rebuilt from the notes on next use.
+    void reload();
+
+    // Write the index to disk if it has been changed.
+    // Should be called at the end of each operation on the store.
+    void flush();
+
+    // Return the store of the notebook of @p_file.
+    // Return NULL if @p_file is not a note or the store is disabled.
+    static VImageStore *fromFile(const VFile *p_file);
+
+    // Fetch local relative images of @p_file which should be cleaned up by the
+    // note: internal images and external images managed by @p_store.
+    // @p_store could be NULL.
+    static QVector<ImageLink> fetchImagesToCleanUp(VFile *p_file, VImageStore *p_store);
+
+    static QByteArray hashData(const QByteArray &p_data);
+
+    // Return empty if fail to read @p_path.
+    static QByteArray hashFile(const QString &p_path);
+
+private:
+    void load();
+
+    bool save() const;
+
+    // Key of @p_path in the index.
+    QString pathKey(const QString &p_path) const;
+
+    // Absolute path of key @p_key.
+    QString keyPath(const QString &p_key) const;
+
+    // Replace the images referred by note @p_noteKey with @p_imageKeys.
+    void setNoteImages(const QString &p_noteKey, const QSet<QString> &p_imageKeys);
+
+    // Return keys of the managed images referred by note @p_notePath on disk.
+    QSet<QString> fetchNoteImages(const QString &p_notePath);
+
+    // Forget image @p_key and its references.
+    void removeImage(const QString &p_key);
+
+    // Re-fetch the references of all the notes from disk.
+    void rebuild();
+
+    // Rebuild the index if any note referring to image @p_key is missing.
+    void checkReferences(const QString &p_key);
+
+    // Whether notes other than @p_noteKey use image @p_key.
+    bool isReferred(const QString &p_key, const QString &p_noteKey);
+
+    // Whether @p_key is @p_excludedKey or under it.
+    static bool isExcluded(const QString &p_key, const QString &p_excludedKey);
+
+    const VNotebook *m_notebook;
+
+    QString m_notebookPath;
+
+    bool m_loaded;
+
+    // Whether the index has been changed since last save.
+    bool m_dirty;
+
+    // Hash -> path relative to the notebook.
+    QHash<QByteArray, QString> m_images;
+
+    // Path key -> hash.
+    QHash<QString, QByteArray> m_pathToHash;
+
+    // Path key of image -> path keys of notes referring to it on disk.
+    QHash<QString, QSet<QString>> m_references;
+
+    // Path key of note -> path keys of images it refers to.
+    QHash<QString, QSet<QString>> m_noteImages;
+
+    // Path key of image -> path keys of notes which took it in this session
+    // but have not been saved yet.
+    QHash<QString, QSet<QString>> m_pins;
+
+    // Name of the index file in the root folder of the notebook.
+    static const QString c_indexFile;
+};
+
+#endif // VIMAGESTORE_H
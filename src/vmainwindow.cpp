@@ -57,6 +57,9 @@ VMainWindow::VMainWindow(VSingleInstanceGuard *p_guard, QWidget *p_parent)
     : QMainWindow(p_parent), m_guard(p_guard),
       m_windowOldState(Qt::WindowNoState), m_requestQuit(false)
 {
+    QElapsedTimer timer;
+    timer.start();
+
     qsrand(QDateTime::currentDateTime().toTime_t());
 
     g_mainWin = this;
@@ -75,7 +78,9 @@ VMainWindow::VMainWindow(VSingleInstanceGuard *p_guard, QWidget *p_parent)
 
     setupUI();
 
+    qint64 menuBarStart = timer.elapsed();
     initMenuBar();
+    qint64 menuBarTime = timer.elapsed() - menuBarStart;
 
     initToolBar();
 
@@ -94,6 +99,9 @@ VMainWindow::VMainWindow(VSingleInstanceGuard *p_guard, QWidget *p_parent)
     initSharedMemoryWatcher();
 
     registerCaptainAndNavigationTargets();
+
+    qDebug() << "main window constructed in" << timer.elapsed() << "ms, menu bar in"
+             << menuBarTime << "ms";
 }
 
 void VMainWindow::initSharedMemoryWatcher()
@@ -781,17 +789,22 @@ void VMainWindow::initMarkdownMenu()
     QMenu *markdownMenu = menuBar()->addMenu(tr("&Markdown"));
     markdownMenu->setToolTipsVisible(true);
 
-    initConverterMenu(markdownMenu);
+    QMenu *converterMenu = markdownMenu->addMenu(tr("&Converter"));
+    initMenuLazily(converterMenu, &VMainWindow::initConverterMenu);
 
-    initMarkdownitOptionMenu(markdownMenu);
+    QMenu *optMenu = markdownMenu->addMenu(tr("Markdown-it Options"));
+    initMenuLazily(optMenu, &VMainWindow::initMarkdownitOptionMenu);
 
     markdownMenu->addSeparator();
 
-    initRenderStyleMenu(markdownMenu);
+    QMenu *styleMenu = markdownMenu->addMenu(tr("Rendering &Style"));
+    initMenuLazily(styleMenu, &VMainWindow::initRenderStyleMenu);
 
-    initRenderBackgroundMenu(markdownMenu);
+    QMenu *renderBgMenu = markdownMenu->addMenu(tr("&Rendering Background"));
+    initMenuLazily(renderBgMenu, &VMainWindow::initRenderBackgroundMenu);
 
-    initCodeBlockStyleMenu(markdownMenu);
+    QMenu *codeBlockStyleMenu = markdownMenu->addMenu(tr("Code Block Style"));
+    initMenuLazily(codeBlockStyleMenu, &VMainWindow::initCodeBlockStyleMenu);
 
     QAction *constrainImageAct = new QAction(tr("Constrain The Width of Images"), this);
     constrainImageAct->setToolTip(tr("Constrain the width of images to the window in read mode (re-open current tabs to make it work)"));
@@ -1181,11 +1194,14 @@ void VMainWindow::initEditMenu()
 
     editMenu->addSeparator();
 
-    initEditorStyleMenu(editMenu);
+    QMenu *styleMenu = editMenu->addMenu(tr("Editor &Style"));
+    initMenuLazily(styleMenu, &VMainWindow::initEditorStyleMenu);
 
-    initEditorBackgroundMenu(editMenu);
+    QMenu *backgroundColorMenu = editMenu->addMenu(tr("&Background Color"));
+    initMenuLazily(backgroundColorMenu, &VMainWindow::initEditorBackgroundMenu);
 
-    initEditorLineNumberMenu(editMenu);
+    QMenu *lineNumMenu = editMenu->addMenu(tr("Line Number"));
+    initMenuLazily(lineNumMenu, &VMainWindow::initEditorLineNumberMenu);
 
     editMenu->addAction(cursorLineAct);
     cursorLineAct->setChecked(g_config->getHighlightCursorLine());
@@ -1336,12 +1352,23 @@ void VMainWindow::setEditorBackgroundColor(QAction *action)
     g_config->setCurBackgroundColor(action->data().toString());
 }
 
+void VMainWindow::initMenuLazily(QMenu *p_menu, void (VMainWindow::*p_init)(QMenu *))
+{
+    // Rebuild the menu each time it is shown to reflect current config and
+    // styles. Actions and action groups are owned by the menu.
+    connect(p_menu, &QMenu::aboutToShow,
+            this, [this, p_menu, p_init]() {
+                p_menu->clear();
+                qDeleteAll(p_menu->findChildren<QActionGroup *>(QString(), Qt::FindDirectChildrenOnly));
+                (this->*p_init)(p_menu);
+            });
+}
+
 void VMainWindow::initConverterMenu(QMenu *p_menu)
 {
-    QMenu *converterMenu = p_menu->addMenu(tr("&Converter"));
-    converterMenu->setToolTipsVisible(true);
+    p_menu->setToolTipsVisible(true);
 
-    QActionGroup *converterAct = new QActionGroup(this);
+    QActionGroup *converterAct = new QActionGroup(p_menu);
     QAction *markedAct = new QAction(tr("Marked"), converterAct);
     markedAct->setToolTip(tr("Use Marked to convert Markdown to HTML (re-open current tabs to make it work)"));
     markedAct->setCheckable(true);
@@ -1364,10 +1391,10 @@ void VMainWindow::initConverterMenu(QMenu *p_menu)
 
     connect(converterAct, &QActionGroup::triggered,
             this, &VMainWindow::changeMarkdownConverter);
-    converterMenu->addAction(hoedownAct);
-    converterMenu->addAction(markedAct);
-    converterMenu->addAction(markdownitAct);
-    converterMenu->addAction(showdownAct);
+    p_menu->addAction(hoedownAct);
+    p_menu->addAction(markedAct);
+    p_menu->addAction(markdownitAct);
+    p_menu->addAction(showdownAct);
 
     MarkdownConverterType converterType = g_config->getMdConverterType();
     switch (converterType) {
@@ -1394,12 +1421,11 @@ void VMainWindow::initConverterMenu(QMenu *p_menu)
 
 void VMainWindow::initMarkdownitOptionMenu(QMenu *p_menu)
 {
-    QMenu *optMenu = p_menu->addMenu(tr("Markdown-it Options"));
-    optMenu->setToolTipsVisible(true);
+    p_menu->setToolTipsVisible(true);
 
     MarkdownitOption opt = g_config->getMarkdownitOption();
 
-    QAction *htmlAct = new QAction(tr("HTML"), this);
+    QAction *htmlAct = new QAction(tr("HTML"), p_menu);
     htmlAct->setToolTip(tr("Enable HTML tags in source"));
     htmlAct->setCheckable(true);
     htmlAct->setChecked(opt.m_html);
@@ -1410,7 +1436,7 @@ void VMainWindow::initMarkdownitOptionMenu(QMenu *p_menu)
                 g_config->setMarkdownitOption(opt);
             });
 
-    QAction *breaksAct = new QAction(tr("Line Break"), this);
+    QAction *breaksAct = new QAction(tr("Line Break"), p_menu);
     breaksAct->setToolTip(tr("Convert '\\n' in paragraphs into line break"));
     breaksAct->setCheckable(true);
     breaksAct->setChecked(opt.m_breaks);
@@ -1421,7 +1447,7 @@ void VMainWindow::initMarkdownitOptionMenu(QMenu *p_menu)
                 g_config->setMarkdownitOption(opt);
             });
 
-    QAction *linkifyAct = new QAction(tr("Linkify"), this);
+    QAction *linkifyAct = new QAction(tr("Linkify"), p_menu);
     linkifyAct->setToolTip(tr("Convert URL-like text into links"));
     linkifyAct->setCheckable(true);
     linkifyAct->setChecked(opt.m_linkify);
@@ -1432,19 +1458,18 @@ void VMainWindow::initMarkdownitOptionMenu(QMenu *p_menu)
                 g_config->setMarkdownitOption(opt);
             });
 
-    optMenu->addAction(htmlAct);
-    optMenu->addAction(breaksAct);
-    optMenu->addAction(linkifyAct);
+    p_menu->addAction(htmlAct);
+    p_menu->addAction(breaksAct);
+    p_menu->addAction(linkifyAct);
 }
 
-void VMainWindow::initRenderBackgroundMenu(QMenu *menu)
+void VMainWindow::initRenderBackgroundMenu(QMenu *p_menu)
 {
-    QActionGroup *renderBackgroundAct = new QActionGroup(this);
+    QActionGroup *renderBackgroundAct = new QActionGroup(p_menu);
     connect(renderBackgroundAct, &QActionGroup::triggered,
             this, &VMainWindow::setRenderBackgroundColor);
 
-    QMenu *renderBgMenu = menu->addMenu(tr("&Rendering Background"));
-    renderBgMenu->setToolTipsVisible(true);
+    p_menu->setToolTipsVisible(true);
     const QString &curBgColor = g_config->getCurRenderBackgroundColor();
     QAction *tmpAct = new QAction(tr("System"), renderBackgroundAct);
     tmpAct->setToolTip(tr("Use system's background color configuration for Markdown rendering"));
@@ -1453,7 +1478,7 @@ void VMainWindow::initRenderBackgroundMenu(QMenu *menu)
     if (curBgColor == "System") {
         tmpAct->setChecked(true);
     }
-    renderBgMenu->addAction(tmpAct);
+    p_menu->addAction(tmpAct);
 
     const QVector<VColor> &bgColors = g_config->getCustomColors();
     for (int i = 0; i < bgColors.size(); ++i) {
@@ -1473,18 +1498,17 @@ void VMainWindow::initRenderBackgroundMenu(QMenu *menu)
             tmpAct->setChecked(true);
         }
 
-        renderBgMenu->addAction(tmpAct);
+        p_menu->addAction(tmpAct);
     }
 }
 
 void VMainWindow::initRenderStyleMenu(QMenu *p_menu)
 {
-    QMenu *styleMenu = p_menu->addMenu(tr("Rendering &Style"));
-    styleMenu->setToolTipsVisible(true);
+    p_menu->setToolTipsVisible(true);
 
     QAction *addAct = newAction(VIconUtils::menuIcon(":/resources/icons/add_style.svg"),
                                 tr("Add Style"),
-                                styleMenu);
+                                p_menu);
     addAct->setToolTip(tr("Add custom style of read mode"));
     connect(addAct, &QAction::triggered,
             this, [this]() {
@@ -1498,9 +1522,9 @@ void VMainWindow::initRenderStyleMenu(QMenu *p_menu)
                 dialog.exec();
             });
 
-    styleMenu->addAction(addAct);
+    p_menu->addAction(addAct);
 
-    QActionGroup *ag = new QActionGroup(this);
+    QActionGroup *ag = new QActionGroup(p_menu);
     connect(ag, &QActionGroup::triggered,
             this, [this](QAction *p_action) {
                 if (!p_action) {
@@ -1522,7 +1546,7 @@ void VMainWindow::initRenderStyleMenu(QMenu *p_menu)
         act->setData(style);
 
         // Add it to the menu.
-        styleMenu->addAction(act);
+        p_menu->addAction(act);
 
         if (curStyle == style) {
             act->setChecked(true);
@@ -1532,12 +1556,11 @@ void VMainWindow::initRenderStyleMenu(QMenu *p_menu)
 
 void VMainWindow::initCodeBlockStyleMenu(QMenu *p_menu)
 {
-    QMenu *styleMenu = p_menu->addMenu(tr("Code Block Style"));
-    styleMenu->setToolTipsVisible(true);
+    p_menu->setToolTipsVisible(true);
 
     QAction *addAct = newAction(VIconUtils::menuIcon(":/resources/icons/add_style.svg"),
                                 tr("Add Style"),
-                                styleMenu);
+                                p_menu);
     addAct->setToolTip(tr("Add custom style of code block in read mode"));
     connect(addAct, &QAction::triggered,
             this, [this]() {
@@ -1551,9 +1574,9 @@ void VMainWindow::initCodeBlockStyleMenu(QMenu *p_menu)
                 dialog.exec();
             });
 
-    styleMenu->addAction(addAct);
+    p_menu->addAction(addAct);
 
-    QActionGroup *ag = new QActionGroup(this);
+    QActionGroup *ag = new QActionGroup(p_menu);
     connect(ag, &QActionGroup::triggered,
             this, [this](QAction *p_action) {
                 if (!p_action) {
@@ -1575,7 +1598,7 @@ void VMainWindow::initCodeBlockStyleMenu(QMenu *p_menu)
         act->setData(style);
 
         // Add it to the menu.
-        styleMenu->addAction(act);
+        p_menu->addAction(act);
 
         if (curStyle == style) {
             act->setChecked(true);
@@ -1583,12 +1606,11 @@ void VMainWindow::initCodeBlockStyleMenu(QMenu *p_menu)
     }
 }
 
-void VMainWindow::initEditorBackgroundMenu(QMenu *menu)
+void VMainWindow::initEditorBackgroundMenu(QMenu *p_menu)
 {
-    QMenu *backgroundColorMenu = menu->addMenu(tr("&Background Color"));
-    backgroundColorMenu->setToolTipsVisible(true);
+    p_menu->setToolTipsVisible(true);
 
-    QActionGroup *backgroundColorAct = new QActionGroup(this);
+    QActionGroup *backgroundColorAct = new QActionGroup(p_menu);
     connect(backgroundColorAct, &QActionGroup::triggered,
             this, &VMainWindow::setEditorBackgroundColor);
 
@@ -1601,7 +1623,7 @@ void VMainWindow::initEditorBackgroundMenu(QMenu *menu)
     if (curBgColor == "System") {
         tmpAct->setChecked(true);
     }
-    backgroundColorMenu->addAction(tmpAct);
+    p_menu->addAction(tmpAct);
     const QVector<VColor> &bgColors = g_config->getCustomColors();
     for (int i = 0; i < bgColors.size(); ++i) {
         tmpAct = new QAction(bgColors[i].m_name, backgroundColorAct);
@@ -1620,16 +1642,15 @@ void VMainWindow::initEditorBackgroundMenu(QMenu *menu)
             tmpAct->setChecked(true);
         }
 
-        backgroundColorMenu->addAction(tmpAct);
+        p_menu->addAction(tmpAct);
     }
 }
 
 void VMainWindow::initEditorLineNumberMenu(QMenu *p_menu)
 {
-    QMenu *lineNumMenu = p_menu->addMenu(tr("Line Number"));
-    lineNumMenu->setToolTipsVisible(true);
+    p_menu->setToolTipsVisible(true);
 
-    QActionGroup *lineNumAct = new QActionGroup(lineNumMenu);
+    QActionGroup *lineNumAct = new QActionGroup(p_menu);
     connect(lineNumAct, &QActionGroup::triggered,
             this, [this](QAction *p_action){
                 if (!p_action) {
@@ -1646,7 +1667,7 @@ void VMainWindow::initEditorLineNumberMenu(QMenu *p_menu)
     act->setToolTip(tr("Do not display line number in edit mode"));
     act->setCheckable(true);
     act->setData(0);
-    lineNumMenu->addAction(act);
+    p_menu->addAction(act);
     if (lineNumberMode == 0) {
         act->setChecked(true);
     }
@@ -1655,7 +1676,7 @@ void VMainWindow::initEditorLineNumberMenu(QMenu *p_menu)
     act->setToolTip(tr("Display absolute line number in edit mode"));
     act->setCheckable(true);
     act->setData(1);
-    lineNumMenu->addAction(act);
+    p_menu->addAction(act);
     if (lineNumberMode == 1) {
         act->setChecked(true);
     }
@@ -1664,7 +1685,7 @@ void VMainWindow::initEditorLineNumberMenu(QMenu *p_menu)
     act->setToolTip(tr("Display line number relative to current cursor line in edit mode"));
     act->setCheckable(true);
     act->setData(2);
-    lineNumMenu->addAction(act);
+    p_menu->addAction(act);
     if (lineNumberMode == 2) {
         act->setChecked(true);
     }
@@ -1673,7 +1694,7 @@ void VMainWindow::initEditorLineNumberMenu(QMenu *p_menu)
     act->setToolTip(tr("Display line number in code block in edit mode (for Markdown only)"));
     act->setCheckable(true);
     act->setData(3);
-    lineNumMenu->addAction(act);
+    p_menu->addAction(act);
     if (lineNumberMode == 3) {
         act->setChecked(true);
     }
@@ -1681,12 +1702,11 @@ void VMainWindow::initEditorLineNumberMenu(QMenu *p_menu)
 
 void VMainWindow::initEditorStyleMenu(QMenu *p_menu)
 {
-    QMenu *styleMenu = p_menu->addMenu(tr("Editor &Style"));
-    styleMenu->setToolTipsVisible(true);
+    p_menu->setToolTipsVisible(true);
 
     QAction *addAct = newAction(VIconUtils::menuIcon(":/resources/icons/add_style.svg"),
                                 tr("Add Style"),
-                                styleMenu);
+                                p_menu);
     addAct->setToolTip(tr("Add custom style of editor"));
     connect(addAct, &QAction::triggered,
             this, [this]() {
@@ -1700,9 +1720,9 @@ void VMainWindow::initEditorStyleMenu(QMenu *p_menu)
                 dialog.exec();
             });
 
-    styleMenu->addAction(addAct);
+    p_menu->addAction(addAct);
 
-    QActionGroup *ag = new QActionGroup(this);
+    QActionGroup *ag = new QActionGroup(p_menu);
     connect(ag, &QActionGroup::triggered,
             this, [this](QAction *p_action) {
                 if (!p_action) {
@@ -1722,7 +1742,7 @@ void VMainWindow::initEditorStyleMenu(QMenu *p_menu)
         act->setData(item);
 
         // Add it to the menu.
-        styleMenu->addAction(act);
+        p_menu->addAction(act);
 
         if (style == item) {
             act->setChecked(true);
@@ -2356,18 +2376,8 @@ void VMainWindow::openFiles(const QStringList &p_files,
                             OpenFileMode p_mode,
                             bool p_forceMode)
 {
-    for (int i = 0; i < p_files.size(); ++i) {
-        VFile *file = NULL;
-        if (!p_forceOrphan) {
-            file = vnote->getInternalFile(p_files[i]);
-        }
-
-        if (!file) {
-            file = vnote->getOrphanFile(p_files[i], true);
-        }
-
-        editArea->openFile(file, p_mode, p_forceMode);
-    }
+    QVector<VFile *> files = vnote->getFiles(p_files, p_forceOrphan);
+    editArea->openFiles(files, p_mode, p_forceMode);
 }
 
 void VMainWindow::editOrphanFileInfo(VFile *p_file)
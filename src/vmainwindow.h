@@ -193,7 +193,12 @@ private:
 
     void initDockWindows();
 
-    void initRenderBackgroundMenu(QMenu *menu);
+    // Call @p_init to fill @p_menu right before it is shown, each time.
+    void initMenuLazily(QMenu *p_menu, void (VMainWindow::*p_init)(QMenu *));
+
+    // The following functions fill the submenu @p_menu. Actions and action
+    // groups created should be owned by @p_menu.
+    void initRenderBackgroundMenu(QMenu *p_menu);
 
     void initRenderStyleMenu(QMenu *p_menu);
 
@@ -201,12 +206,12 @@ private:
 
     void initConverterMenu(QMenu *p_menu);
     void initMarkdownitOptionMenu(QMenu *p_menu);
-    void initEditorBackgroundMenu(QMenu *menu);
+    void initEditorBackgroundMenu(QMenu *p_menu);
 
     // Init the Line Number submenu in Edit menu.
     void initEditorLineNumberMenu(QMenu *p_menu);
 
-    void initEditorStyleMenu(QMenu *p_emnu);
+    void initEditorStyleMenu(QMenu *p_menu);
     void updateWindowTitle(const QString &str);
 
     // Update state of actions according to @p_tab.
@@ -78,9 +78,6 @@ VMdEdit::VMdEdit(VFile *p_file, VDocument *p_vdoc, MarkdownConverterType p_type,
 
     connect(this, &VMdEdit::cursorPositionChanged,
             this, &VMdEdit::updateCurrentHeader);
-
-    connect(QApplication::clipboard(), &QClipboard::changed,
-            this, &VMdEdit::handleClipboardChanged);
     */
 
     updateFontAndPalette();
@@ -634,38 +631,26 @@ bool VMdEdit::getPreviewImageRegionOfBlock(const QTextBlock &p_block,
     return true;
 }
 
-void VMdEdit::handleClipboardChanged(QClipboard::Mode p_mode)
+QMimeData *VMdEdit::createMimeDataFromSelection() const
 {
-    if (!hasFocus()) {
-        return;
-    }
-
-    if (p_mode == QClipboard::Clipboard) {
-        QClipboard *clipboard = QApplication::clipboard();
-        const QMimeData *mimeData = clipboard->mimeData();
-        if (mimeData->hasText()) {
-            QString text = mimeData->text();
-            if (clipboard->ownsClipboard()) {
-                if (text.trimmed() == QString(QChar::ObjectReplacementCharacter)) {
-                    QImage image = tryGetSelectedImage();
-                    clipboard->clear(QClipboard::Clipboard);
-                    if (!image.isNull()) {
-                        clipboard->setImage(image, QClipboard::Clipboard);
-                    }
-                } else {
-                    // Try to remove all the preview image in text.
-                    VEditUtils::removeObjectReplacementCharacter(text);
-                    if (text.size() != mimeData->text().size()) {
-                        clipboard->clear(QClipboard::Clipboard);
-                        clipboard->setText(text);
-                    }
-                }
-            }
+    QMimeData *data = new QMimeData();
+    QString text = VEditUtils::selectedText(textCursor());
+    if (text.trimmed() == QString(QChar::ObjectReplacementCharacter)) {
+        // Only a preview image is selected.
+        QImage image = tryGetSelectedImage();
+        if (!image.isNull()) {
+            data->setImageData(image);
         }
+
+        return data;
     }
+
+    VEditUtils::removeObjectReplacementCharacter(text);
+    data->setText(text);
+    return data;
 }
 
-QImage VMdEdit::tryGetSelectedImage()
+QImage VMdEdit::tryGetSelectedImage() const
 {
     QImage image;
     QTextCursor cursor = textCursor();
@@ -60,12 +60,13 @@ private slots:
     // When there is no header in current cursor, will signal an invalid header.
     void updateCurrentHeader();
 
-    void handleClipboardChanged(QClipboard::Mode p_mode);
-
 protected:
     void keyPressEvent(QKeyEvent *event) Q_DECL_OVERRIDE;
     bool canInsertFromMimeData(const QMimeData *source) const Q_DECL_OVERRIDE;
     void insertFromMimeData(const QMimeData *source) Q_DECL_OVERRIDE;
+
+    // Copy the Markdown source of the selection without the preview images.
+    QMimeData *createMimeDataFromSelection() const Q_DECL_OVERRIDE;
     void updateFontAndPalette() Q_DECL_OVERRIDE;
     void resizeEvent(QResizeEvent *p_event) Q_DECL_OVERRIDE;
 
@@ -95,7 +96,7 @@ private:
 
     // There is a QChar::ObjectReplacementCharacter (and maybe some spaces)
     // in the selection. Get the QImage.
-    QImage tryGetSelectedImage();
+    QImage tryGetSelectedImage() const;
 
     QString getPlainTextWithoutPreviewImage() const;
 
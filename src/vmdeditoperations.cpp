@@ -12,6 +12,7 @@
 #include <QGuiApplication>
 #include <QApplication>
 #include <QClipboard>
+#include <QPointer>
 #include "vmdeditoperations.h"
 #include "dialog/vinsertimagedialog.h"
 #include "dialog/vselectdialog.h"
@@ -23,11 +24,15 @@
 #include "vconfigmanager.h"
 #include "utils/vvim.h"
 #include "utils/veditutils.h"
+#include "vimagesaver.h"
+#include "vimagestore.h"
 
 extern VConfigManager *g_config;
 
 const QString VMdEditOperations::c_defaultImageTitle = "";
 
+const QString VMdEditOperations::c_pendingImageUrlPrefix = "vnote-pending-image:";
+
 VMdEditOperations::VMdEditOperations(VEditor *p_editor, VFile *p_file)
     : VEditOperations(p_editor, p_file), m_autoIndentPos(-1)
 {
@@ -56,6 +61,39 @@ bool VMdEditOperations::insertImageFromMimeData(const QMimeData *source)
     return true;
 }
 
+// The editor has gone before the image is written. Finish the link in the
+// note file if it is saved with the placeholder, otherwise no one will refer
+// to the image and it is removed.
+static void finishInsertImageWithoutEditor(VFile *p_file,
+                                           const QString &p_notePath,
+                                           const QString &p_placeholder,
+                                           const QString &p_md,
+                                           const QString &p_filePath,
+                                           const QByteArray &p_hash)
+{
+    QString text = VUtils::readFileFromDisk(p_notePath);
+    if (!text.contains(p_placeholder)) {
+        qDebug() << "remove image of discarded link" << p_filePath;
+        QFile::remove(p_filePath);
+        return;
+    }
+
+    text.replace(p_placeholder, p_md);
+    if (!VUtils::writeFileToDisk(p_notePath, text)) {
+        qWarning() << "fail to finish image link in note" << p_notePath << p_filePath;
+        return;
+    }
+
+    VImageStore *store = VImageStore::fromFile(p_file);
+    if (store && !p_hash.isEmpty()) {
+        store->addImage(p_hash, p_filePath);
+        store->addReference(p_filePath, p_notePath);
+        store->flush();
+    }
+
+    qDebug() << "finish image link in note" << p_notePath << p_filePath;
+}
+
 void VMdEditOperations::insertImageFromQImage(const QString &title, const QString &path,
                                               const QString &folderInLink, const QImage &image)
 {
@@ -63,43 +101,142 @@ void VMdEditOperations::insertImageFromQImage(const QString &title, const QStrin
     QString filePath = QDir(path).filePath(fileName);
     V_ASSERT(!QFile(filePath).exists());
 
-    QString errStr;
-    bool ret = VUtils::makePath(path);
-    if (!ret) {
-        errStr = tr("Fail to create image folder <span style=\"%1\">%2</span>.")
-                   .arg(g_config->c_dataTextStyle).arg(path);
-    } else {
-        ret = image.save(filePath);
-        if (!ret) {
-            errStr = tr("Fail to save image <span style=\"%1\">%2</span>.")
-                       .arg(g_config->c_dataTextStyle).arg(filePath);
+    // Insert a placeholder link first and save the image in a worker.
+    // The placeholder will be replaced by the real link once the image is
+    // written, so the note never refers to an image not on disk.
+    QString url = QString("%1/%2").arg(folderInLink).arg(fileName);
+    QString md = QString("![%1](%2)").arg(title).arg(url);
+    QString placeholder = QString("![%1](%2%3)").arg(title).arg(c_pendingImageUrlPrefix).arg(fileName);
+    insertTextAtCurPos(placeholder);
+
+    // Track the placeholder across later edits.
+    QTextCursor linkCursor(m_editor->documentW());
+    int endPos = m_editor->textCursorW().position();
+    linkCursor.setPosition(endPos - placeholder.size());
+    linkCursor.setPosition(endPos, QTextCursor::KeepAnchor);
+
+    emit statusMessage(tr("Saving image %1").arg(fileName));
+
+    QPointer<VMdEditOperations> ops(this);
+    QPointer<VFile> file(m_file);
+    QString notePath = m_file->fetchPath();
+    VImageSaver *saver = new VImageSaver(image, path, filePath);
+    saver->setComputeHash(VImageStore::fromFile(m_file) != NULL);
+    // Use the application as the context to get the result even if the
+    // editor is closed in the meantime.
+    connect(saver, &VImageSaver::finished,
+            qApp, [ops, file, notePath, title, url, md, placeholder, linkCursor](bool p_succeed,
+                                                                               const QString &p_filePath,
+                                                                               const QString &p_errStr,
+                                                                               const QByteArray &p_hash) {
+                if (ops) {
+                    ops->finishInsertImage(p_succeed,
+                                           title,
+                                           url,
+                                           md,
+                                           placeholder,
+                                           linkCursor,
+                                           p_filePath,
+                                           p_errStr,
+                                           p_hash);
+                } else if (p_succeed) {
+                    finishInsertImageWithoutEditor(file, notePath, placeholder, md, p_filePath, p_hash);
+                }
+            }, Qt::QueuedConnection);
+    saver->start();
+}
+
+void VMdEditOperations::finishInsertImage(bool p_succeed,
+                                          const QString &p_title,
+                                          const QString &p_url,
+                                          const QString &p_md,
+                                          const QString &p_placeholder,
+                                          QTextCursor p_linkCursor,
+                                          const QString &p_filePath,
+                                          const QString &p_errStr,
+                                          const QByteArray &p_hash)
+{
+    VMdEditor *mdEditor = dynamic_cast<VMdEditor *>(m_editor);
+    Q_ASSERT(mdEditor);
+
+    bool linkIntact = !p_linkCursor.isNull() && p_linkCursor.selectedText() == p_placeholder;
+    if (!p_succeed) {
+        // Roll back the placeholder if user does not touch it.
+        if (linkIntact) {
+            p_linkCursor.removeSelectedText();
         }
-    }
 
-    if (!ret) {
         VUtils::showMessage(QMessageBox::Warning, tr("Warning"),
-                            tr("Fail to insert image <span style=\"%1\">%2</span>.").arg(g_config->c_dataTextStyle).arg(title),
-                            errStr,
+                            tr("Fail to insert image <span style=\"%1\">%2</span>.").arg(g_config->c_dataTextStyle).arg(p_title),
+                            p_errStr,
                             QMessageBox::Ok,
                             QMessageBox::Ok,
                             m_editor->getEditor());
         return;
     }
 
-    QString url = QString("%1/%2").arg(folderInLink).arg(fileName);
-    QString md = QString("![%1](%2)").arg(title).arg(url);
-    insertTextAtCurPos(md);
+    if (!linkIntact) {
+        // User has modified or removed the placeholder.
+        qDebug() << "remove image of discarded link" << p_filePath;
+        QFile::remove(p_filePath);
+        return;
+    }
 
-    qDebug() << "insert image" << title << filePath;
+    QString filePath = p_filePath;
+    QString url = p_url;
+    QString md = p_md;
+    VImageStore *store = VImageStore::fromFile(m_file);
+    if (store && !p_hash.isEmpty()) {
+        QString existingPath = store->findImage(p_hash);
+        if (existingPath.isEmpty()) {
+            store->addImage(p_hash, filePath);
+        } else {
+            // Reuse the existing image. No one refers to the new one yet.
+            QFile::remove(filePath);
+            store->refImage(existingPath, m_file->fetchPath());
+
+            filePath = existingPath;
+            url = QDir(m_file->fetchBasePath()).relativeFilePath(existingPath);
+            md = QString("![%1](%2)").arg(p_title).arg(url);
+            qDebug() << "reuse identical image" << existingPath;
+        }
+
+        store->flush();
+    }
+
+    p_linkCursor.insertText(md);
+
+    qDebug() << "insert image" << p_title << filePath;
 
-    VMdEditor *mdEditor = dynamic_cast<VMdEditor *>(m_editor);
-    Q_ASSERT(mdEditor);
     mdEditor->imageInserted(filePath, url);
+
+    emit statusMessage(tr("Image %1 saved").arg(QFileInfo(filePath).fileName()));
 }
 
 void VMdEditOperations::insertImageFromPath(const QString &title, const QString &path,
                                             const QString &folderInLink, const QString &oriImagePath)
 {
+    VImageStore *store = VImageStore::fromFile(m_file);
+    QByteArray hash;
+    if (store) {
+        hash = VImageStore::hashFile(oriImagePath);
+        QString existingPath = hash.isEmpty() ? QString() : store->findImage(hash);
+        store->flush();
+        if (!existingPath.isEmpty()) {
+            store->refImage(existingPath, m_file->fetchPath());
+
+            QString url = QDir(m_file->fetchBasePath()).relativeFilePath(existingPath);
+            insertTextAtCurPos(QString("![%1](%2)").arg(title).arg(url));
+
+            qDebug() << "insert identical image" << title << existingPath;
+
+            VMdEditor *mdEditor = dynamic_cast<VMdEditor *>(m_editor);
+            Q_ASSERT(mdEditor);
+            mdEditor->imageInserted(existingPath, url);
+            return;
+        }
+    }
+
     QString fileName = VUtils::generateImageFileName(path, title, QFileInfo(oriImagePath).suffix());
     QString filePath = QDir(path).filePath(fileName);
     V_ASSERT(!QFile(filePath).exists());
@@ -127,6 +264,11 @@ void VMdEditOperations::insertImageFromPath(const QString &title, const QString
         return;
     }
 
+    if (store && !hash.isEmpty()) {
+        store->addImage(hash, filePath);
+        store->flush();
+    }
+
     QString url = QString("%1/%2").arg(folderInLink).arg(fileName);
     QString md = QString("![%1](%2)").arg(title).arg(url);
     insertTextAtCurPos(md);
@@ -6,6 +6,7 @@
 #include <QUrl>
 #include <QImage>
 #include <QTextBlock>
+#include <QTextCursor>
 #include "veditoperations.h"
 
 class QTimer;
@@ -35,6 +36,8 @@ public:
 private:
     // Insert image from @oriImagePath as @path.
     // @folderInLink: the folder part in the image link.
+    // If image deduplication is enabled, an identical image in the notebook
+    // will be reused instead.
     void insertImageFromPath(const QString &title, const QString &path,
                              const QString &folderInLink, const QString &oriImagePath);
 
@@ -42,9 +45,26 @@ private:
     // @path: the image folder path to insert the image in;
     // @folderInLink: the folder part in the image link.
     // @image: the image to be inserted;
+    // A placeholder link is inserted at once while the image is encoded and
+    // written in a worker thread. The placeholder is replaced by the real link
+    // once the image is written, or rolled back if it fails.
     void insertImageFromQImage(const QString &title, const QString &path,
                                const QString &folderInLink, const QImage &image);
 
+    // Called when the image of a placeholder link has been written.
+    // @p_md: the real link to replace the placeholder @p_placeholder.
+    // @p_linkCursor: selection of the placeholder.
+    // @p_hash: hash of the image data if image deduplication is enabled.
+    void finishInsertImage(bool p_succeed,
+                           const QString &p_title,
+                           const QString &p_url,
+                           const QString &p_md,
+                           const QString &p_placeholder,
+                           QTextCursor p_linkCursor,
+                           const QString &p_filePath,
+                           const QString &p_errStr,
+                           const QByteArray &p_hash);
+
     // Key press handlers.
     bool handleKeyTab(QKeyEvent *p_event);
     bool handleKeyBackTab(QKeyEvent *p_event);
@@ -84,6 +104,9 @@ private:
     int m_autoIndentPos;
 
     static const QString c_defaultImageTitle;
+
+    // Url prefix of the placeholder link of an image being saved.
+    static const QString c_pendingImageUrlPrefix;
 };
 
 #endif // VMDEDITOPERATIONS_H
@@ -20,6 +20,7 @@
 #include "vpreviewmanager.h"
 #include "utils/viconutils.h"
 #include "dialog/vcopytextashtmldialog.h"
+#include "vimagestore.h"
 
 extern VConfigManager *g_config;
 
@@ -551,14 +552,16 @@ void VMdEditor::updateCurrentHeader()
 
 void VMdEditor::initInitImages()
 {
-    m_initImages = VUtils::fetchImagesFromMarkdownFile(m_file,
-                                                       ImageLink::LocalRelativeInternal);
+    m_initImages = VImageStore::fetchImagesToCleanUp(m_file, VImageStore::fromFile(m_file));
 }
 
 void VMdEditor::clearUnusedImages()
 {
-    QVector<ImageLink> images = VUtils::fetchImagesFromMarkdownFile(m_file,
-                                                                    ImageLink::LocalRelativeInternal);
+    VImageStore *store = VImageStore::fromFile(m_file);
+    QVector<ImageLink> images = VImageStore::fetchImagesToCleanUp(m_file, store);
+    if (store) {
+        store->updateReferences(m_file->fetchPath(), images);
+    }
 
     QSet<QString> unusedImages;
 
@@ -566,7 +569,10 @@ void VMdEditor::clearUnusedImages()
         for (int i = 0; i < m_insertedImages.size(); ++i) {
             const ImageLink &link = m_insertedImages[i];
 
-            if (link.m_type != ImageLink::LocalRelativeInternal) {
+            if (link.m_type != ImageLink::LocalRelativeInternal
+                && !(link.m_type == ImageLink::LocalRelativeExternal
+                     && store
+                     && store->contains(link.m_path))) {
                 continue;
             }
 
@@ -589,8 +595,6 @@ void VMdEditor::clearUnusedImages()
     for (int i = 0; i < m_initImages.size(); ++i) {
         const ImageLink &link = m_initImages[i];
 
-        V_ASSERT(link.m_type == ImageLink::LocalRelativeInternal);
-
         int j;
         for (j = 0; j < images.size(); ++j) {
             if (VUtils::equalPath(link.m_path, images[j].m_path)) {
@@ -643,6 +647,11 @@ void VMdEditor::clearUnusedImages()
         }
 
         for (auto const & item : unusedImages) {
+            if (store && !store->releaseImage(item, m_file->fetchPath())) {
+                // Still used by other notes.
+                continue;
+            }
+
             bool ret = false;
             if (m_file->getType() == FileType::Note) {
                 const VNoteFile *tmpFile = dynamic_cast<const VNoteFile *>((VFile *)m_file);
@@ -662,6 +671,10 @@ void VMdEditor::clearUnusedImages()
         }
     }
 
+    if (store) {
+        store->flush();
+    }
+
     m_initImages.clear();
 }
 
@@ -721,6 +734,22 @@ bool VMdEditor::canInsertFromMimeData(const QMimeData *p_source) const
            || VTextEdit::canInsertFromMimeData(p_source);
 }
 
+QMimeData *VMdEditor::createMimeDataFromSelection() const
+{
+    // QTextEdit's mime data fills its plain text from the document fragment
+    // lazily, which will override any text set on it. Build the rich text
+    // ourselves and take the plain text from the source directly.
+    QTextCursor cursor = textCursor();
+    QString text = VEditUtils::selectedText(cursor);
+    text.replace(QChar::LineSeparator, '\n');
+    text.replace(QChar::Nbsp, ' ');
+
+    QMimeData *data = new QMimeData();
+    data->setHtml(QTextDocumentFragment(cursor).toHtml());
+    data->setText(text);
+    return data;
+}
+
 void VMdEditor::insertFromMimeData(const QMimeData *p_source)
 {
     VSelectDialog dialog(tr("Insert From Clipboard"), this);
@@ -793,7 +822,9 @@ void VMdEditor::imageInserted(const QString &p_path, const QString &p_url)
     link.m_path = p_path;
     link.m_url = p_url;
     if (m_file->useRelativeImageFolder()) {
-        link.m_type = ImageLink::LocalRelativeInternal;
+        // An identical image of other notes may be reused.
+        link.m_type = m_file->isInternalImageFolder(VUtils::basePathFromPath(p_path)) ?
+                      ImageLink::LocalRelativeInternal : ImageLink::LocalRelativeExternal;
     } else {
         link.m_type = ImageLink::LocalAbsolute;
     }
@@ -1003,8 +1034,16 @@ void VMdEditor::updateInitAndInsertedImages(bool p_fileChanged, UpdateAction p_a
         // Update inserted images.
         // Inserted images should be moved manually here. Then update all the
         // paths.
+        VImageStore *store = VImageStore::fromFile(m_file);
         for (auto & link : m_insertedImages) {
-            if (link.m_type == ImageLink::LocalAbsolute) {
+            // Reused images of other notes stay where they are.
+            if (link.m_type == ImageLink::LocalAbsolute
+                || link.m_type == ImageLink::LocalRelativeExternal) {
+                continue;
+            }
+
+            // Do not move images shared with other notes.
+            if (store && store->isShared(link.m_path, m_file->fetchPath())) {
                 continue;
             }
 
@@ -1026,8 +1065,16 @@ void VMdEditor::updateInitAndInsertedImages(bool p_fileChanged, UpdateAction p_a
                 continue;
             }
 
+            if (store) {
+                store->moveImage(link.m_path, newPath);
+            }
+
             link.m_path = newPath;
         }
+
+        if (store) {
+            store->flush();
+        }
     } else {
         // Directory changed.
         // Update inserted images.
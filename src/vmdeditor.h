@@ -200,6 +200,10 @@ protected:
 
     void insertFromMimeData(const QMimeData *p_source) Q_DECL_OVERRIDE;
 
+    // Copy the Markdown source of the selection as plain text along with the
+    // rich text.
+    QMimeData *createMimeDataFromSelection() const Q_DECL_OVERRIDE;
+
     void wheelEvent(QWheelEvent *p_event) Q_DECL_OVERRIDE;
 
 private slots:
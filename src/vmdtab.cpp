@@ -27,14 +27,18 @@ extern VMainWindow *g_mainWin;
 extern VConfigManager *g_config;
 
 VMdTab::VMdTab(VFile *p_file, VEditArea *p_editArea,
-               OpenFileMode p_mode, QWidget *p_parent)
+               OpenFileMode p_mode, QWidget *p_parent, bool p_deferred)
     : VEditTab(p_file, p_editArea, p_parent),
       m_editor(NULL),
       m_webViewer(NULL),
       m_document(NULL),
       m_mdConType(g_config->getMdConverterType()),
       m_enableHeadingSequence(false),
-      m_backupFileChecked(false)
+      m_stacks(NULL),
+      m_backupTimer(NULL),
+      m_backupFileChecked(false),
+      m_lineFromEditMode(-1),
+      m_materialized(!p_deferred)
 {
     V_ASSERT(m_file->getDocType() == DocType::Markdown);
 
@@ -48,8 +52,6 @@ VMdTab::VMdTab(VFile *p_file, VEditArea *p_editArea,
         m_enableHeadingSequence = true;
     }
 
-    setupUI();
-
     m_backupTimer = new QTimer(this);
     m_backupTimer->setSingleShot(true);
     m_backupTimer->setInterval(g_config->getFileTimerInterval());
@@ -58,6 +60,12 @@ VMdTab::VMdTab(VFile *p_file, VEditArea *p_editArea,
                 writeBackupFile();
             });
 
+    if (!m_materialized) {
+        return;
+    }
+
+    setupUI();
+
     if (p_mode == OpenFileMode::Edit) {
         showFileEditMode();
     } else {
@@ -65,6 +73,19 @@ VMdTab::VMdTab(VFile *p_file, VEditArea *p_editArea,
     }
 }
 
+void VMdTab::materialize()
+{
+    if (m_materialized) {
+        return;
+    }
+
+    m_materialized = true;
+
+    setupUI();
+
+    showFileReadMode();
+}
+
 void VMdTab::setupUI()
 {
     m_stacks = new QStackedLayout(this);
@@ -83,6 +104,7 @@ void VMdTab::showFileReadMode()
 
     // Will recover the header when web side is ready.
     m_headerFromEditMode = m_currentHeader;
+    m_lineFromEditMode = m_editor ? m_editor->firstVisibleBlock().blockNumber() : -1;
 
     if (m_mdConType == MarkdownConverterType::Hoedown) {
         viewWebByConverter();
@@ -224,6 +246,12 @@ void VMdTab::showFileEditMode()
 
     scrollEditorToHeader(header);
 
+    // Source line is more precise than header if the renderer supports it.
+    int line = m_document ? m_document->getSourceLine() : -1;
+    if (line > -1) {
+        mdEdit->scrollToBlock(line);
+    }
+
     mdEdit->setFocus();
 }
 
@@ -249,6 +277,8 @@ void VMdTab::editFile()
         return;
     }
 
+    materialize();
+
     showFileEditMode();
 }
 
@@ -406,6 +436,12 @@ void VMdTab::setupMarkdownViewer()
                     // Recover header from edit mode.
                     scrollWebViewToHeader(m_headerFromEditMode);
                     m_headerFromEditMode.clear();
+
+                    if (m_lineFromEditMode > -1) {
+                        m_document->scrollToLine(m_lineFromEditMode);
+                        m_lineFromEditMode = -1;
+                    }
+
                     return;
                 }
 
@@ -621,7 +657,7 @@ QString VMdTab::getSelectedText() const
         QTextCursor cursor = m_editor->textCursor();
         return cursor.selectedText();
     } else {
-        return m_webViewer->selectedText();
+        return m_webViewer ? m_webViewer->selectedText() : QString();
     }
 }
 
@@ -711,6 +747,8 @@ MarkdownConverterType VMdTab::getMarkdownConverterType() const
 
 void VMdTab::focusChild()
 {
+    materialize();
+
     m_stacks->currentWidget()->setFocus();
 }
 
@@ -883,6 +921,11 @@ VInsertSelector *VMdTab::prepareSnippetSelector(QWidget *p_parent)
 
 void VMdTab::reload()
 {
+    // It will read the file once materialized.
+    if (!m_materialized) {
+        return;
+    }
+
     if (m_isEditMode) {
         m_editor->reloadFile();
         m_editor->endEdit();
@@ -1001,6 +1044,10 @@ void VMdTab::updateCursorStatus()
 
 void VMdTab::handleFileOrDirectoryChange(bool p_isFile, UpdateAction p_act)
 {
+    if (!m_materialized) {
+        return;
+    }
+
     // Reload the web view with new base URL.
     m_headerFromEditMode = m_currentHeader;
     m_webViewer->setHtml(VUtils::generateHtmlTemplate(m_mdConType, false),
@@ -20,7 +20,10 @@ class VMdTab : public VEditTab
     Q_OBJECT
 
 public:
-    VMdTab(VFile *p_file, VEditArea *p_editArea, OpenFileMode p_mode, QWidget *p_parent = 0);
+    // @p_deferred: whether set up the viewer and editor until it is materialized.
+    // A deferred tab will be in read mode.
+    VMdTab(VFile *p_file, VEditArea *p_editArea, OpenFileMode p_mode,
+           QWidget *p_parent = 0, bool p_deferred = false);
 
     // Close current tab.
     // @p_forced: if true, discard the changes.
@@ -79,6 +82,8 @@ public:
     // Evaluate magic words.
     void evaluateMagicWords() Q_DECL_OVERRIDE;
 
+    void materialize() Q_DECL_OVERRIDE;
+
     void applySnippet(const VSnippet *p_snippet) Q_DECL_OVERRIDE;
 
     void applySnippet() Q_DECL_OVERRIDE;
@@ -203,6 +208,12 @@ private:
 
     // Used to scroll to the header of edit mode in read mode.
     VHeaderPointer m_headerFromEditMode;
+
+    // Used to scroll to the top source line of edit mode in read mode.
+    int m_lineFromEditMode;
+
+    // Whether the viewer has been set up.
+    bool m_materialized;
 };
 
 inline VMdEditor *VMdTab::getEditor()
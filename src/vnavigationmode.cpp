@@ -65,31 +65,27 @@ void VNavigationMode::showNavigation(QListWidget *p_widget)
     }
 }
 
+// Only items within the viewport are fetched, starting from the one at the top
+// edge, so it does not depend on the total number of items.
 QList<QListWidgetItem *> VNavigationMode::getVisibleItems(const QListWidget *p_widget) const
 {
     QList<QListWidgetItem *> items;
-    for (int i = 0; i < p_widget->count(); ++i) {
-        QListWidgetItem *item = p_widget->item(i);
-        if (!item->isHidden()) {
-            items.append(item);
+    const QRect viewRect = p_widget->viewport()->rect();
+    QModelIndex topIdx = p_widget->indexAt(viewRect.topLeft());
+    int row = topIdx.isValid() ? topIdx.row() : 0;
+    for (; row < p_widget->count(); ++row) {
+        QListWidgetItem *item = p_widget->item(row);
+        if (item->isHidden()) {
+            continue;
         }
-    }
 
-    return items;
-}
+        QRect rect = p_widget->visualItemRect(item);
+        if (rect.top() > viewRect.bottom()) {
+            break;
+        }
 
-static QList<QTreeWidgetItem *> getVisibleChildItems(const QTreeWidgetItem *p_item)
-{
-    QList<QTreeWidgetItem *> items;
-    if (p_item && !p_item->isHidden() && p_item->isExpanded()) {
-        for (int i = 0; i < p_item->childCount(); ++i) {
-            QTreeWidgetItem *child = p_item->child(i);
-            if (!child->isHidden()) {
-                items.append(child);
-                if (child->isExpanded()) {
-                    items.append(getVisibleChildItems(child));
-                }
-            }
+        if (rect.bottom() >= viewRect.top()) {
+            items.append(item);
         }
     }
 
@@ -99,13 +95,25 @@ static QList<QTreeWidgetItem *> getVisibleChildItems(const QTreeWidgetItem *p_it
 QList<QTreeWidgetItem *> VNavigationMode::getVisibleItems(const QTreeWidget *p_widget) const
 {
     QList<QTreeWidgetItem *> items;
-    for (int i = 0; i < p_widget->topLevelItemCount(); ++i) {
-        QTreeWidgetItem *item = p_widget->topLevelItem(i);
-        if (!item->isHidden()) {
+    const QRect viewRect = p_widget->viewport()->rect();
+    QTreeWidgetItem *item = p_widget->itemAt(viewRect.topLeft());
+    if (!item && p_widget->topLevelItemCount() > 0) {
+        item = p_widget->topLevelItem(0);
+    }
+
+    // itemBelow() follows the expanded and non-hidden items.
+    for (; item; item = p_widget->itemBelow(item)) {
+        if (item->isHidden()) {
+            continue;
+        }
+
+        QRect rect = p_widget->visualItemRect(item);
+        if (rect.top() > viewRect.bottom()) {
+            break;
+        }
+
+        if (rect.bottom() >= viewRect.top()) {
             items.append(item);
-            if (item->isExpanded()) {
-                items.append(getVisibleChildItems(item));
-            }
         }
     }
 
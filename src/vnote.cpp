@@ -7,12 +7,14 @@
 #include <QFontMetrics>
 #include <QStringList>
 #include <QFontDatabase>
+#include <QSet>
 #include "vnote.h"
 #include "utils/vutils.h"
 #include "vconfigmanager.h"
 #include "vmainwindow.h"
 #include "vorphanfile.h"
 #include "vnotefile.h"
+#include "vdirectory.h"
 #include "vpalette.h"
 
 extern VConfigManager *g_config;
@@ -267,6 +269,132 @@ VNoteFile *VNote::getInternalFile(const QString &p_path)
     return file;
 }
 
+// Key of @p_path to look up files.
+static QString pathKey(const QString &p_path)
+{
+    QString path = QDir::cleanPath(p_path);
+#if defined(Q_OS_WIN)
+    path = path.toLower();
+#endif
+    return path;
+}
+
+// Return the notes in folder @p_folder as name key -> note, one hash for each
+// of @p_notebooks containing the folder, in the same order.
+static QVector<QHash<QString, VNoteFile *>> fetchNotesInFolder(const QVector<VNotebook *> &p_notebooks,
+                                                                const QString &p_folder)
+{
+    QVector<QHash<QString, VNoteFile *>> notes;
+    for (auto nb : p_notebooks) {
+        VDirectory *dir = NULL;
+        if (pathKey(nb->getPath()) == pathKey(p_folder)) {
+            if (nb->open()) {
+                dir = nb->getRootDir();
+            }
+        } else {
+            dir = nb->tryLoadDirectory(p_folder);
+        }
+
+        if (!dir || !dir->open()) {
+            continue;
+        }
+
+        QHash<QString, VNoteFile *> hash;
+        const QVector<VNoteFile *> &files = dir->getFiles();
+        hash.reserve(files.size());
+        for (auto file : files) {
+            hash.insert(pathKey(file->getName()), file);
+        }
+
+        notes.append(hash);
+    }
+
+    return notes;
+}
+
+QVector<VFile *> VNote::getFiles(const QStringList &p_paths, bool p_forceOrphan)
+{
+    QVector<VFile *> files(p_paths.size(), NULL);
+
+    if (!p_forceOrphan) {
+        // Files in the same folder belong to the same notebooks and folders,
+        // so load each folder once and look up its notes by name.
+        QHash<QString, QVector<QHash<QString, VNoteFile *>>> folderNotes;
+        for (int i = 0; i < p_paths.size(); ++i) {
+            if (p_paths[i].isEmpty() || !QFileInfo::exists(p_paths[i])) {
+                continue;
+            }
+
+            QString folder = VUtils::basePathFromPath(p_paths[i]);
+            QString key = pathKey(folder);
+            auto it = folderNotes.find(key);
+            if (it == folderNotes.end()) {
+                it = folderNotes.insert(key, fetchNotesInFolder(m_notebooks, folder));
+            }
+
+            QString name = pathKey(VUtils::fileNameFromPath(p_paths[i]));
+            for (auto const & notes : it.value()) {
+                auto nit = notes.find(name);
+                if (nit != notes.end()) {
+                    files[i] = nit.value();
+                    break;
+                }
+            }
+        }
+    }
+
+    // Look up opened orphan files via a hash instead of one scan per path.
+    QHash<QString, VOrphanFile *> orphans;
+    for (auto file : m_externalFiles) {
+        orphans.insert(pathKey(file->fetchPath()), file);
+    }
+
+    QSet<VOrphanFile *> used;
+    for (int i = 0; i < p_paths.size(); ++i) {
+        if (files[i] || p_paths[i].isEmpty()) {
+            continue;
+        }
+
+        auto it = orphans.find(pathKey(p_paths[i]));
+        if (it != orphans.end()) {
+            files[i] = it.value();
+            used.insert(it.value());
+        }
+    }
+
+    for (int i = 0; i < m_externalFiles.size(); ++i) {
+        VOrphanFile *file = m_externalFiles[i];
+        if (!file->isOpened() && !used.contains(file)) {
+            qDebug() << "release orphan file" << file;
+            m_externalFiles.removeAt(i);
+            delete file;
+            --i;
+        }
+    }
+
+    for (int i = 0; i < p_paths.size(); ++i) {
+        if (files[i] || p_paths[i].isEmpty()) {
+            continue;
+        }
+
+        // The same path may appear more than once.
+        QString key = pathKey(p_paths[i]);
+        auto it = orphans.find(key);
+        if (it != orphans.end() && used.contains(it.value())) {
+            files[i] = it.value();
+            continue;
+        }
+
+        VOrphanFile *file = new VOrphanFile(this, QDir::cleanPath(p_paths[i]), true, false);
+        m_externalFiles.append(file);
+        orphans.insert(key, file);
+        used.insert(file);
+        files[i] = file;
+    }
+
+    return files;
+}
+
 VFile *VNote::getFile(const QString &p_path)
 {
     VFile *file = getInternalFile(p_path);
@@ -94,6 +94,11 @@ public:
     // Otherwise, returns NULL.
     VNoteFile *getInternalFile(const QString &p_path);
 
+    // Given the paths of files, first try to open them as note files, then
+    // try to open them as orphan files, in one pass.
+    // The i-th item of the result corresponds to @p_paths[i].
+    QVector<VFile *> getFiles(const QStringList &p_paths, bool p_forceOrphan = false);
+
     // Given the path of a folder, try to find it in all notebooks.
     // Returns a VDirectory struct if it is a folder in one notebook.
     // Otherwise, returns NULL.
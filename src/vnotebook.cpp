@@ -5,11 +5,12 @@
 #include "utils/vutils.h"
 #include "vconfigmanager.h"
 #include "vnotefile.h"
+#include "vimagestore.h"
 
 extern VConfigManager *g_config;
 
 VNotebook::VNotebook(const QString &name, const QString &path, QObject *parent)
-    : QObject(parent), m_name(name), m_valid(false)
+    : QObject(parent), m_name(name), m_valid(false), m_imageStore(NULL)
 {
     m_path = QDir::cleanPath(path);
     m_recycleBinFolder = g_config->getRecycleBinFolder();
@@ -22,6 +23,7 @@ VNotebook::VNotebook(const QString &name, const QString &path, QObject *parent)
 VNotebook::~VNotebook()
 {
     delete m_rootDir;
+    delete m_imageStore;
 }
 
 bool VNotebook::readConfigNotebook()
@@ -367,3 +369,32 @@ QString VNotebook::getRecycleBinFolderPath() const
         return QDir(m_path).filePath(m_recycleBinFolder);
     }
 }
+
+VImageStore *VNotebook::getImageStore() const
+{
+    if (!g_config->getEnableImageDedup()) {
+        return NULL;
+    }
+
+    if (!m_imageStore) {
+        m_imageStore = new VImageStore(this);
+    }
+
+    return m_imageStore;
+}
+
+bool VNotebook::auditAttachments(QVector<QString> &p_missing, QVector<QString> &p_unlisted)
+{
+    bool opened = isOpened();
+    if (!open()) {
+        return false;
+    }
+
+    m_rootDir->auditAttachments(p_missing, p_unlisted);
+
+    if (!opened) {
+        close();
+    }
+
+    return true;
+}
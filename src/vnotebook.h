@@ -4,10 +4,12 @@
 #include <QObject>
 #include <QString>
 #include <QDateTime>
+#include <QVector>
 
 class VDirectory;
 class VFile;
 class VNoteFile;
+class VImageStore;
 
 class VNotebook : public QObject
 {
@@ -95,6 +97,17 @@ public:
 
     bool isValid() const;
 
+    // Check attachments of all the notes in this notebook.
+    // @p_missing: paths of attachments missing in disk;
+    // @p_unlisted: paths of files or folders in attachment folders which do
+    // not belong to any note.
+    // Return false if fail to open the notebook.
+    bool auditAttachments(QVector<QString> &p_missing, QVector<QString> &p_unlisted);
+
+    // Get the content-addressed image store of this notebook.
+    // Return NULL if image deduplication is disabled.
+    VImageStore *getImageStore() const;
+
 private:
     // Serialize current instance to json.
     QJsonObject toConfigJson() const;
@@ -124,6 +137,9 @@ private:
     // Whether this notebook is valid.
     // Will set to true after readConfigNotebook().
     bool m_valid;
+
+    // Created on demand.
+    mutable VImageStore *m_imageStore;
 };
 
 inline VDirectory *VNotebook::getRootDir() const
@@ -154,6 +154,81 @@ void VNotebookSelector::initActions()
                                         this);
                 }
             });
+
+    m_auditAttachmentsAct = new QAction(tr("&Audit Attachments"), this);
+    m_auditAttachmentsAct->setToolTip(tr("Check attachments of all the notes in this notebook "
+                                         "for missing and unlisted files"));
+    connect(m_auditAttachmentsAct, &QAction::triggered,
+            this, [this]() {
+                QList<QListWidgetItem *> items = this->m_listWidget->selectedItems();
+                if (items.isEmpty()) {
+                    return;
+                }
+
+                Q_ASSERT(items.size() == 1);
+                VNotebook *notebook = getNotebook(items[0]);
+                auditAttachments(notebook);
+            });
+}
+
+void VNotebookSelector::auditAttachments(VNotebook *p_notebook)
+{
+    QVector<QString> missing, unlisted;
+    if (!p_notebook->auditAttachments(missing, unlisted)) {
+        VUtils::showMessage(QMessageBox::Warning,
+                            tr("Warning"),
+                            tr("Fail to open notebook <span style=\"%1\">%2</span>.")
+                              .arg(g_config->c_dataTextStyle)
+                              .arg(p_notebook->getName()),
+                            "",
+                            QMessageBox::Ok,
+                            QMessageBox::Ok,
+                            this);
+        return;
+    }
+
+    QString text = tr("Found %1 missing attachments and %2 unlisted files in the attachment "
+                      "folders of notebook <span style=\"%3\">%4</span>.")
+                     .arg(missing.size())
+                     .arg(unlisted.size())
+                     .arg(g_config->c_dataTextStyle)
+                     .arg(p_notebook->getName());
+
+    // Limit the number of items to show.
+    const int maxItems = 50;
+    auto listItems = [maxItems](const QVector<QString> &p_paths) {
+        QStringList list;
+        for (int i = 0; i < p_paths.size() && i < maxItems; ++i) {
+            list << p_paths[i].toHtmlEscaped();
+        }
+
+        if (p_paths.size() > maxItems) {
+            list << "...";
+        }
+
+        return list.join("<br/>");
+    };
+
+    QString info;
+    if (!missing.isEmpty()) {
+        info += tr("Missing attachments:<br/>%1").arg(listItems(missing));
+    }
+
+    if (!unlisted.isEmpty()) {
+        if (!info.isEmpty()) {
+            info += "<br/><br/>";
+        }
+
+        info += tr("Unlisted files:<br/>%1").arg(listItems(unlisted));
+    }
+
+    VUtils::showMessage(QMessageBox::Information,
+                        tr("Information"),
+                        text,
+                        info,
+                        QMessageBox::Ok,
+                        QMessageBox::Ok,
+                        this);
 }
 
 void VNotebookSelector::updateComboBox()
@@ -475,6 +550,7 @@ void VNotebookSelector::popupListContextMenuRequested(QPoint p_pos)
         menu.addSeparator();
         menu.addAction(m_recycleBinAct);
         menu.addAction(m_emptyRecycleBinAct);
+        menu.addAction(m_auditAttachmentsAct);
     }
 
     menu.addSeparator();
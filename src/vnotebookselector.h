@@ -64,6 +64,9 @@ private slots:
 private:
     void initActions();
 
+    // Check attachments of @p_notebook and show the result.
+    void auditAttachments(VNotebook *p_notebook);
+
     // Update Combox from m_notebooks.
     void updateComboBox();
 
@@ -115,6 +118,7 @@ private:
     QAction *m_openLocationAct;
     QAction *m_recycleBinAct;
     QAction *m_emptyRecycleBinAct;
+    QAction *m_auditAttachmentsAct;
 
     QLabel *m_naviLabel;
 };
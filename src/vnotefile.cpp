@@ -9,6 +9,7 @@
 #include <QDebug>
 
 #include "utils/vutils.h"
+#include "vimagestore.h"
 #include "vdirectory.h"
 
 VNoteFile::VNoteFile(VDirectory *p_directory,
@@ -89,6 +90,12 @@ bool VNoteFile::rename(const QString &p_name)
 
     m_docType = VUtils::docTypeFromName(m_name);
 
+    VImageStore *store = getNotebook()->getImageStore();
+    if (store) {
+        store->renamePath(diskDir.filePath(oldName), fetchPath());
+        store->flush();
+    }
+
     qDebug() << "file renamed from" << oldName << "to" << m_name;
     return true;
 }
@@ -210,15 +217,26 @@ bool VNoteFile::deleteInternalImages()
 {
     Q_ASSERT(parent() && m_docType == DocType::Markdown);
 
-    QVector<ImageLink> images = VUtils::fetchImagesFromMarkdownFile(this,
-                                                                    ImageLink::LocalRelativeInternal);
+    VImageStore *store = getNotebook()->getImageStore();
+    QVector<ImageLink> images = VImageStore::fetchImagesToCleanUp(this, store);
     int deleted = 0;
     for (int i = 0; i < images.size(); ++i) {
+        if (store && !store->releaseImage(images[i].m_path, fetchPath())) {
+            // Still used by other notes.
+            ++deleted;
+            continue;
+        }
+
         if (VUtils::deleteFile(getNotebook(), images[i].m_path, false)) {
             ++deleted;
         }
     }
 
+    if (store) {
+        store->removeReferences(fetchPath());
+        store->flush();
+    }
+
     qDebug() << "delete" << deleted << "images for" << m_name << fetchPath();
 
     return deleted == images.size();
@@ -242,6 +260,7 @@ bool VNoteFile::addAttachment(const QString &p_file)
     }
 
     m_attachments.push_back(VAttachment(name));
+    invalidateAttachmentListing();
 
     if (!getDirectory()->updateFileConfig(this)) {
         qWarning() << "fail to update config of file" << m_name
@@ -316,6 +335,8 @@ bool VNoteFile::deleteAttachments(const QVector<QString> &p_names,
         }
     }
 
+    invalidateAttachmentListing();
+
     // Delete the attachment folder if m_attachments is empty now.
     if (m_attachments.isEmpty()) {
         dir.cdUp();
@@ -384,6 +405,7 @@ bool VNoteFile::renameAttachment(const QString &p_oldName, const QString &p_newN
     }
 
     m_attachments[idx].m_name = p_newName;
+    invalidateAttachmentListing();
 
     if (!getDirectory()->updateFileConfig(this)) {
         qWarning() << "fail to rename attachment in config" << p_oldName << p_newName;
@@ -397,14 +419,63 @@ bool VNoteFile::renameAttachment(const QString &p_oldName, const QString &p_newN
     return true;
 }
 
+QString VNoteFile::attachmentFolderPath() const
+{
+    if (m_attachmentFolder.isEmpty()) {
+        return QString();
+    }
+
+    QDir dir(QDir(fetchBasePath()).filePath(getNotebook()->getAttachmentFolder()));
+    return dir.filePath(m_attachmentFolder);
+}
+
+QString VNoteFile::attachmentListingKey(const QString &p_name)
+{
+#if defined(Q_OS_WIN) || defined(Q_OS_MACOS) || defined(Q_OS_MAC)
+    return p_name.toLower();
+#else
+    return p_name;
+#endif
+}
+
+const QHash<QString, QString> &VNoteFile::fetchAttachmentListing(const QString &p_folderPath)
+{
+    QDateTime modifiedTime = QFileInfo(p_folderPath).lastModified();
+    if (m_attachmentListingPath == p_folderPath
+        && m_attachmentListingTime == modifiedTime) {
+        return m_attachmentListing;
+    }
+
+    m_attachmentListing.clear();
+    m_attachmentListingPath = p_folderPath;
+    m_attachmentListingTime = modifiedTime;
+
+    // Avoid listing current directory.
+    if (p_folderPath.isEmpty()) {
+        return m_attachmentListing;
+    }
+
+    QDir dir(p_folderPath);
+    QStringList files = dir.entryList(QDir::Files | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot);
+    m_attachmentListing.reserve(files.size());
+    for (auto const & file : files) {
+        m_attachmentListing.insert(attachmentListingKey(file), file);
+    }
+
+    return m_attachmentListing;
+}
+
 QVector<QString> VNoteFile::checkAttachments()
 {
     QVector<QString> missing;
+    if (m_attachments.isEmpty()) {
+        return missing;
+    }
 
-    QDir dir(fetchAttachmentFolderPath());
+    // List the folder once instead of checking each attachment.
+    const QHash<QString, QString> &listing = fetchAttachmentListing(attachmentFolderPath());
     for (auto const & atta : m_attachments) {
-        QString file = dir.filePath(atta.m_name);
-        if (!QFileInfo::exists(file)) {
+        if (!listing.contains(attachmentListingKey(atta.m_name))) {
             missing.push_back(atta.m_name);
         }
     }
@@ -412,6 +483,31 @@ QVector<QString> VNoteFile::checkAttachments()
     return missing;
 }
 
+void VNoteFile::auditAttachments(QVector<QString> &p_missing, QVector<QString> &p_unlisted)
+{
+    if (m_attachmentFolder.isEmpty()) {
+        return;
+    }
+
+    // Do not create the folder since auditing should not change the notebook.
+    QString folderPath = attachmentFolderPath();
+    QDir dir(folderPath);
+    QHash<QString, QString> listing = fetchAttachmentListing(folderPath);
+    for (auto const & atta : m_attachments) {
+        if (listing.remove(attachmentListingKey(atta.m_name)) > 0) {
+            continue;
+        }
+
+        p_missing.push_back(dir.filePath(atta.m_name));
+    }
+
+    QStringList unlisted = listing.values();
+    unlisted.sort();
+    for (auto const & name : unlisted) {
+        p_unlisted.push_back(dir.filePath(name));
+    }
+}
+
 bool VNoteFile::deleteFile(VNoteFile *p_file, QString *p_errMsg)
 {
     Q_ASSERT(!p_file->isOpened());
@@ -470,10 +566,17 @@ bool VNoteFile::copyFile(VDirectory *p_destDir,
     Q_ASSERT(docType == VUtils::docTypeFromName(p_destName));
 
     // Images to be copied.
+    // With the image store, external images managed by it are included.
+    VImageStore *srcStore = p_file->getNotebook()->getImageStore();
     QVector<ImageLink> images;
+    // Whether the image is used by other notes.
+    QVector<bool> sharedImages;
     if (docType == DocType::Markdown) {
-        images = VUtils::fetchImagesFromMarkdownFile(p_file,
-                                                     ImageLink::LocalRelativeInternal);
+        images = VImageStore::fetchImagesToCleanUp(p_file, srcStore);
+        sharedImages.reserve(images.size());
+        for (auto const & link : images) {
+            sharedImages.append(srcStore && srcStore->isShared(link.m_path, srcPath));
+        }
     }
 
     // Attachments to be copied.
@@ -511,6 +614,10 @@ bool VNoteFile::copyFile(VDirectory *p_destDir,
 
     // Copy images.
     QDir parentDir(destFile->fetchBasePath());
+    VImageStore *destStore = destFile->getNotebook()->getImageStore();
+    bool sameStore = srcStore && srcStore == destStore;
+    // Old url -> new url of the image links to update in the target note.
+    QHash<QString, QString> urls;
     QSet<QString> processedImages;
     for (int i = 0; i < images.size(); ++i) {
         const ImageLink &link = images[i];
@@ -527,27 +634,92 @@ bool VNoteFile::copyFile(VDirectory *p_destDir,
             continue;
         }
 
-        QString imageFolder = VUtils::directoryNameFromPath(VUtils::basePathFromPath(link.m_path));
-        QString destImagePath = QDir(parentDir.filePath(imageFolder)).filePath(VUtils::fileNameFromPath(link.m_path));
+        QString destImagePath;
+        if (link.m_type == ImageLink::LocalRelativeExternal) {
+            // Image of other notes managed by the store.
+            if (sameStore) {
+                // Keep sharing it and just update the link.
+                QString url = parentDir.relativeFilePath(link.m_path);
+                if (url != link.m_url) {
+                    urls.insert(link.m_url, url);
+                }
+
+                continue;
+            }
 
-        if (VUtils::equalPath(link.m_path, destImagePath)) {
-            VUtils::addErrMsg(p_errMsg, tr("Skip image with the same source and target path %1.")
-                                          .arg(link.m_path));
-            ret = false;
-            continue;
+            QString folderPath = destFile->fetchImageFolderPath();
+            QString fileName = VUtils::generateCopiedFileName(folderPath,
+                                                              VUtils::fileNameFromPath(link.m_path));
+            destImagePath = QDir(folderPath).filePath(fileName);
+            urls.insert(link.m_url, QString("%1/%2").arg(destFile->getImageFolderInLink()).arg(fileName));
+        } else {
+            QString imageFolder = VUtils::directoryNameFromPath(VUtils::basePathFromPath(link.m_path));
+            destImagePath = QDir(parentDir.filePath(imageFolder)).filePath(VUtils::fileNameFromPath(link.m_path));
+
+            if (VUtils::equalPath(link.m_path, destImagePath)) {
+                VUtils::addErrMsg(p_errMsg, tr("Skip image with the same source and target path %1.")
+                                              .arg(link.m_path));
+                ret = false;
+                continue;
+            }
         }
 
-        if (!VUtils::copyFile(link.m_path, destImagePath, p_isCut)) {
+        // Images shared with other notes should be copied instead of moved.
+        bool isCut = p_isCut && !sharedImages[i];
+        if (!VUtils::copyFile(link.m_path, destImagePath, isCut)) {
             VUtils::addErrMsg(p_errMsg, tr("Fail to %1 image %2 to %3. "
                                            "Please manually %1 it and modify the note.")
                                           .arg(opStr).arg(link.m_path).arg(destImagePath));
+            urls.remove(link.m_url);
             ret = false;
         } else {
             ++nrImageCopied;
             qDebug() << opStr << "image" << link.m_path << "to" << destImagePath;
+
+            if (isCut && srcStore) {
+                if (sameStore) {
+                    srcStore->moveImage(link.m_path, destImagePath);
+                } else {
+                    // The image has left the notebook.
+                    srcStore->releaseImage(link.m_path, srcPath);
+                }
+            }
+
+            if (destStore && !sameStore) {
+                QByteArray hash = VImageStore::hashFile(destImagePath);
+                if (!hash.isEmpty() && destStore->findImage(hash).isEmpty()) {
+                    destStore->addImage(hash, destImagePath);
+                }
+            }
+        }
+    }
+
+    if (!urls.isEmpty()) {
+        QString text = VUtils::readFileFromDisk(destPath);
+        if (!VUtils::writeFileToDisk(destPath, VUtils::replaceImageUrlsInMarkdown(text, urls))) {
+            VUtils::addErrMsg(p_errMsg, tr("Fail to update image links of note %1. "
+                                           "Please manually modify the note.")
+                                          .arg(destPath));
+            ret = false;
         }
     }
 
+    if (p_isCut && srcStore) {
+        srcStore->removeReferences(srcPath);
+    }
+
+    if (destStore && docType == DocType::Markdown) {
+        destStore->scanReferences(destPath);
+    }
+
+    if (srcStore) {
+        srcStore->flush();
+    }
+
+    if (destStore && !sameStore) {
+        destStore->flush();
+    }
+
     // Copy attachment folder.
     if (!attaFolderPath.isEmpty()) {
         QDir dir(destFile->fetchBasePath());
@@ -3,6 +3,8 @@
 
 #include <QVector>
 #include <QString>
+#include <QHash>
+#include <QDateTime>
 
 #include "vfile.h"
 
@@ -108,6 +110,11 @@ public:
     // Return the missing attachments' names.
     QVector<QString> checkAttachments();
 
+    // Check the attachment folder against m_attachments.
+    // @p_missing: paths of attachments missing in disk;
+    // @p_unlisted: paths of files in the attachment folder not in m_attachments.
+    void auditAttachments(QVector<QString> &p_missing, QVector<QString> &p_unlisted);
+
     // Create a VNoteFile from @p_json Json object.
     static VNoteFile *fromJson(VDirectory *p_directory,
                                const QJsonObject &p_json,
@@ -137,12 +144,35 @@ private:
     // Delete this file in disk as well as all its images/attachments.
     bool deleteFile(QString *p_msg = NULL);
 
+    // Return the files in attachment folder @p_folderPath as key -> name.
+    // The listing is cached and refreshed only when the modified time of the
+    // folder changes.
+    const QHash<QString, QString> &fetchAttachmentListing(const QString &p_folderPath);
+
+    // Return the attachment folder path without creating it.
+    // Return empty if this file has no attachment folder yet.
+    QString attachmentFolderPath() const;
+
+    // Force to refresh the attachment listing next time.
+    void invalidateAttachmentListing();
+
+    // Key of attachment @p_name in the listing.
+    // Case-insensitive on Windows and macOS, whose file systems are.
+    static QString attachmentListingKey(const QString &p_name);
+
     // Folder under the attachment folder of the notebook.
     // Store all the attachments of current file.
     QString m_attachmentFolder;
 
     // Attachments.
     QVector<VAttachment> m_attachments;
+
+    // Cached listing of the attachment folder.
+    QHash<QString, QString> m_attachmentListing;
+
+    // Path and modified time of the attachment folder when listed.
+    QString m_attachmentListingPath;
+    QDateTime m_attachmentListingTime;
 };
 
 inline const QString &VNoteFile::getAttachmentFolder() const
@@ -153,6 +183,7 @@ inline const QString &VNoteFile::getAttachmentFolder() const
 inline void VNoteFile::setAttachmentFolder(const QString &p_folder)
 {
     m_attachmentFolder = p_folder;
+    invalidateAttachmentListing();
 }
 
 inline const QVector<VAttachment> &VNoteFile::getAttachments() const
@@ -165,4 +196,9 @@ inline void VNoteFile::setAttachments(const QVector<VAttachment> &p_attas)
     m_attachments = p_attas;
 }
 
+inline void VNoteFile::invalidateAttachmentListing()
+{
+    m_attachmentListingPath.clear();
+}
+
 #endif // VNOTEFILE_H
@@ -31,11 +31,17 @@ void VOutline::updateOutline(const VTableOfContent &p_outline)
         return;
     }
 
+    VTableOfContent oldOutline = m_outline;
+    m_outline = p_outline;
+
+    if (updateTreeIncrementally(oldOutline)) {
+        // Items are kept so current header is still valid.
+        return;
+    }
+
     // Clear current header
     m_currentHeader.clear();
 
-    m_outline = p_outline;
-
     updateTreeFromOutline();
 
     expandTree();
@@ -44,16 +50,51 @@ void VOutline::updateOutline(const VTableOfContent &p_outline)
 void VOutline::updateTreeFromOutline()
 {
     clear();
+    m_items.clear();
 
     if (m_outline.isEmpty()) {
         return;
     }
 
     const QVector<VTableOfContentItem> &headers = m_outline.getTable();
+    m_items.resize(headers.size());
     int idx = 0;
     updateTreeByLevel(headers, idx, NULL, NULL, 1);
 }
 
+bool VOutline::updateTreeIncrementally(const VTableOfContent &p_old)
+{
+    if (p_old.isEmpty()
+        || m_outline.isEmpty()
+        || p_old.getFile() != m_outline.getFile()
+        || p_old.getType() != m_outline.getType()) {
+        return false;
+    }
+
+    const QVector<VTableOfContentItem> &oldHeaders = p_old.getTable();
+    const QVector<VTableOfContentItem> &headers = m_outline.getTable();
+    if (oldHeaders.size() != headers.size()
+        || m_items.size() != headers.size()) {
+        return false;
+    }
+
+    // The tree structure depends only on the levels of headers.
+    for (int i = 0; i < headers.size(); ++i) {
+        if (oldHeaders[i].m_level != headers[i].m_level) {
+            return false;
+        }
+    }
+
+    for (int i = 0; i < headers.size(); ++i) {
+        if (!(oldHeaders[i] == headers[i])) {
+            Q_ASSERT(m_items[i]);
+            fillItem(m_items[i], headers[i]);
+        }
+    }
+
+    return true;
+}
+
 void VOutline::updateTreeByLevel(const QVector<VTableOfContentItem> &headers,
                                  int &index,
                                  QTreeWidgetItem *parent,
@@ -71,6 +112,7 @@ void VOutline::updateTreeByLevel(const QVector<VTableOfContentItem> &headers,
             }
 
             fillItem(item, header);
+            m_items[index] = item;
 
             last = item;
             ++index;
@@ -90,6 +132,9 @@ void VOutline::fillItem(QTreeWidgetItem *p_item, const VTableOfContentItem &p_he
 
     if (p_header.isEmpty()) {
         p_item->setForeground(0, QColor("grey"));
+    } else {
+        // Reset the foreground in case this item is reused.
+        p_item->setData(0, Qt::ForegroundRole, QVariant());
     }
 }
 
@@ -142,38 +187,10 @@ void VOutline::selectHeader(const VHeaderPointer &p_header)
         return;
     }
 
-    int nrTop = topLevelItemCount();
-    for (int i = 0; i < nrTop; ++i) {
-        if (selectHeaderOne(topLevelItem(i), p_header)) {
-            return;
-        }
-    }
-}
-
-bool VOutline::selectHeaderOne(QTreeWidgetItem *p_item, const VHeaderPointer &p_header)
-{
-    if (!p_item) {
-        return false;
+    int idx = p_header.m_index;
+    if (idx >= 0 && idx < m_items.size() && m_items[idx]) {
+        setCurrentItem(m_items[idx]);
     }
-
-    const VTableOfContentItem *header = getHeaderFromItem(p_item);
-    if (!header) {
-        return false;
-    }
-
-    if (header->isMatched(p_header)) {
-        setCurrentItem(p_item);
-        return true;
-    }
-
-    int nrChild = p_item->childCount();
-    for (int i = 0; i < nrChild; ++i) {
-        if (selectHeaderOne(p_item->child(i), p_header)) {
-            return true;
-        }
-    }
-
-    return false;
 }
 
 void VOutline::keyPressEvent(QKeyEvent *event)
@@ -48,6 +48,11 @@ private:
     // Update tree according to outline.
     void updateTreeFromOutline();
 
+    // Try to update the tree in place from @p_old to m_outline.
+    // Only changed items will be touched.
+    // Return false if the structure of the tree changes and a rebuild is needed.
+    bool updateTreeIncrementally(const VTableOfContent &p_old);
+
     // @index: the index in @headers.
     void updateTreeByLevel(const QVector<VTableOfContentItem> &headers,
                            int &index,
@@ -60,8 +65,6 @@ private:
     // Set the item corresponding to @p_header as current item.
     void selectHeader(const VHeaderPointer &p_header);
 
-    bool selectHeaderOne(QTreeWidgetItem *p_item, const VHeaderPointer &p_header);
-
     // Fill the info of @p_item.
     void fillItem(QTreeWidgetItem *p_item, const VTableOfContentItem &p_header);
 
@@ -70,6 +73,9 @@ private:
 
     VTableOfContent m_outline;
 
+    // Tree item of each header in m_outline, indexed by the header index.
+    QVector<QTreeWidgetItem *> m_items;
+
     VHeaderPointer m_currentHeader;
 
     // When true, won't emit outlineItemActivated().
@@ -5,6 +5,9 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QDebug>
+#include <QFile>
+#include <QDataStream>
+#include <QCryptographicHash>
 
 #include "utils/vutils.h"
 
@@ -111,12 +114,55 @@ void VPalette::fillStyle(QString &p_text) const
     }
 }
 
-QString VPalette::fetchQtStyleSheet() const
+// Bump it when the layout of the cache file changes.
+static const quint32 c_qtStyleSheetCacheMagic = 0x56515301;
+
+QString VPalette::fetchQtStyleSheet(const QString &p_cacheFolder) const
 {
     QString style = VUtils::readFileFromDisk(m_data.m_qssFile);
+    if (p_cacheFolder.isEmpty()) {
+        fillStyle(style);
+        fillAbsoluteUrl(style);
+        return style;
+    }
+
+    // The resolved style sheet depends on the QSS file, the palette file
+    // and the location of the palette file.
+    QByteArray key;
+    {
+        QDataStream stream(&key, QIODevice::WriteOnly);
+        stream << m_file << style << VUtils::readFileFromDisk(m_file);
+        key = QCryptographicHash::hash(key, QCryptographicHash::Sha1);
+    }
+
+    QDir dir(p_cacheFolder);
+    QFile file(dir.filePath(themeName(m_file) + ".qss.cache"));
+    if (file.open(QIODevice::ReadOnly)) {
+        QDataStream stream(&file);
+        quint32 magic = 0;
+        QByteArray cachedKey;
+        QString cachedStyle;
+        stream >> magic >> cachedKey >> cachedStyle;
+        file.close();
+        if (stream.status() == QDataStream::Ok
+            && magic == c_qtStyleSheetCacheMagic
+            && cachedKey == key) {
+            qDebug() << "use cached Qt style sheet" << file.fileName();
+            return cachedStyle;
+        }
+    }
+
     fillStyle(style);
     fillAbsoluteUrl(style);
 
+    if ((dir.exists() || dir.mkpath(dir.absolutePath()))
+        && file.open(QIODevice::WriteOnly)) {
+        QDataStream stream(&file);
+        stream << c_qtStyleSheetCacheMagic << key << style;
+    } else {
+        qWarning() << "fail to write Qt style sheet cache" << file.fileName();
+    }
+
     return style;
 }
 
@@ -39,7 +39,9 @@ public:
     QString color(const QString &p_name) const;
 
     // Read QSS file.
-    QString fetchQtStyleSheet() const;
+    // If @p_cacheFolder is not empty, the resolved style sheet will be cached
+    // there and reused until the theme files change.
+    QString fetchQtStyleSheet(const QString &p_cacheFolder = QString()) const;
 
     // Fill "@xxx" in @p_text with corresponding style.
     void fillStyle(QString &p_text) const;
@@ -0,0 +1,387 @@
+#include "vpdfmerger.h"
+
+#include <QObject>
+#include <QMap>
+#include <QRegExp>
+#include <QDebug>
+
+const int VPdfMerger::c_catalogObj = 1;
+
+const int VPdfMerger::c_pagesObj = 2;
+
+// An indirect object within a PDF document.
+struct PdfObject
+{
+    // Text after "obj" and before "stream" or "endobj".
+    QString m_text;
+
+    // Range of the stream data within the document. -1 if it is not a stream.
+    int m_streamStart;
+    int m_streamEnd;
+};
+
+static bool isPdfSpace(char p_ch)
+{
+    return p_ch == ' ' || p_ch == '\n' || p_ch == '\r'
+           || p_ch == '\t' || p_ch == '\f' || p_ch == '\0';
+}
+
+static void skipSpaces(const QByteArray &p_data, int &p_pos)
+{
+    while (p_pos < p_data.size() && isPdfSpace(p_data.at(p_pos))) {
+        ++p_pos;
+    }
+}
+
+// Read a non-negative integer at @p_pos after white spaces.
+// Return -1 if there is no integer.
+static qint64 readInteger(const QByteArray &p_data, int &p_pos)
+{
+    skipSpaces(p_data, p_pos);
+
+    int start = p_pos;
+    qint64 val = 0;
+    while (p_pos < p_data.size() && p_data.at(p_pos) >= '0' && p_data.at(p_pos) <= '9') {
+        val = val * 10 + (p_data.at(p_pos) - '0');
+        ++p_pos;
+    }
+
+    return p_pos > start ? val : -1;
+}
+
+// Return the object number referred by key @p_key in dictionary @p_text.
+// Return -1 if not found.
+static int findReference(const QString &p_text, const QString &p_key)
+{
+    QRegExp regExp(QString("/%1\\s*(\\d+)\\s+\\d+\\s+R").arg(p_key));
+    if (regExp.indexIn(p_text) == -1) {
+        return -1;
+    }
+
+    return regExp.cap(1).toInt();
+}
+
+// Add @p_delta to the object number of each reference in @p_text.
+static QString renumberReferences(const QString &p_text, int p_delta)
+{
+    QRegExp regExp("(\\d+)\\s+\\d+\\s+R(?![A-Za-z0-9])");
+    QString text;
+    int last = 0;
+    int pos = 0;
+    while ((pos = regExp.indexIn(p_text, pos)) != -1) {
+        text += p_text.mid(last, pos - last);
+        text += QString("%1 0 R").arg(regExp.cap(1).toInt() + p_delta);
+        pos += regExp.matchedLength();
+        last = pos;
+    }
+
+    text += p_text.mid(last);
+    return text;
+}
+
+// Parse object @p_num within [@p_start, @p_end) of @p_data.
+static bool parseObject(const QByteArray &p_data,
+                        int p_start,
+                        int p_end,
+                        int p_num,
+                        PdfObject &p_obj)
+{
+    QByteArray chunk = QByteArray::fromRawData(p_data.constData() + p_start, p_end - p_start);
+    int pos = 0;
+    if (readInteger(chunk, pos) != p_num || readInteger(chunk, pos) < 0) {
+        return false;
+    }
+
+    skipSpaces(chunk, pos);
+    if (chunk.mid(pos, 3) != "obj") {
+        return false;
+    }
+
+    pos += 3;
+    int endPos = chunk.lastIndexOf("endobj");
+    if (endPos < pos) {
+        return false;
+    }
+
+    int streamPos = chunk.indexOf("stream", pos);
+    if (streamPos == -1 || streamPos > endPos) {
+        p_obj.m_text = QString::fromLatin1(chunk.mid(pos, endPos - pos));
+        p_obj.m_streamStart = p_obj.m_streamEnd = -1;
+        return true;
+    }
+
+    // The EOL before endstream is kept in the data, which is not counted in
+    // the length of the stream.
+    int dataStart = streamPos + 6;
+    if (chunk.at(dataStart) == '\r') {
+        ++dataStart;
+    }
+
+    if (chunk.at(dataStart) == '\n') {
+        ++dataStart;
+    }
+
+    int dataEnd = chunk.lastIndexOf("endstream", endPos);
+    if (dataEnd < dataStart) {
+        return false;
+    }
+
+    p_obj.m_text = QString::fromLatin1(chunk.mid(pos, streamPos - pos));
+    p_obj.m_streamStart = p_start + dataStart;
+    p_obj.m_streamEnd = p_start + dataEnd;
+    return true;
+}
+
+VPdfMerger::VPdfMerger(const QString &p_filePath)
+    : m_file(p_filePath),
+      m_offsets(c_pagesObj + 1, -1),
+      m_nextObj(c_pagesObj + 1),
+      m_pageCount(0)
+{
+}
+
+VPdfMerger::~VPdfMerger()
+{
+    // Still open means not finished.
+    if (m_file.isOpen()) {
+        m_file.close();
+        m_file.remove();
+    }
+}
+
+bool VPdfMerger::open()
+{
+    if (!m_file.open(QFile::WriteOnly)) {
+        return fail(QObject::tr("Fail to open file %1 to write.").arg(m_file.fileName()));
+    }
+
+    // Binary comment to mark the file as binary.
+    const char header[] = "%PDF-1.7\n%\xE2\xE3\xCF\xD3\n";
+    if (m_file.write(header, sizeof(header) - 1) != sizeof(header) - 1) {
+        return fail(QObject::tr("Fail to write file %1.").arg(m_file.fileName()));
+    }
+
+    return true;
+}
+
+bool VPdfMerger::append(const QByteArray &p_data)
+{
+    Q_ASSERT(m_file.isOpen());
+
+    // Locate the cross-reference table.
+    int sxrefPos = p_data.lastIndexOf("startxref");
+    if (sxrefPos == -1) {
+        return fail(QObject::tr("Invalid PDF without cross-reference table."));
+    }
+
+    int pos = sxrefPos + 9;
+    qint64 xrefPos = readInteger(p_data, pos);
+    if (xrefPos < 0
+        || xrefPos >= sxrefPos
+        || !p_data.mid(xrefPos, 4).startsWith("xref")) {
+        return fail(QObject::tr("PDF with cross-reference stream is not supported."));
+    }
+
+    // Offset -> object number, sorted by offset.
+    QMap<qint64, int> objs;
+    pos = xrefPos + 4;
+    while (true) {
+        skipSpaces(p_data, pos);
+        if (pos >= sxrefPos) {
+            return fail(QObject::tr("Invalid PDF without trailer."));
+        }
+
+        if (p_data.mid(pos, 7) == "trailer") {
+            pos += 7;
+            break;
+        }
+
+        qint64 first = readInteger(p_data, pos);
+        qint64 cnt = readInteger(p_data, pos);
+        if (first < 0 || cnt < 0) {
+            return fail(QObject::tr("Invalid cross-reference table in PDF."));
+        }
+
+        for (qint64 i = 0; i < cnt; ++i) {
+            qint64 offset = readInteger(p_data, pos);
+            qint64 gen = readInteger(p_data, pos);
+            skipSpaces(p_data, pos);
+            if (offset < 0 || gen < 0 || pos >= sxrefPos) {
+                return fail(QObject::tr("Invalid cross-reference table in PDF."));
+            }
+
+            char type = p_data.at(pos++);
+            if (type == 'n') {
+                objs.insert(offset, first + i);
+            } else if (type != 'f') {
+                return fail(QObject::tr("Invalid cross-reference table in PDF."));
+            }
+        }
+    }
+
+    QString trailer = QString::fromLatin1(p_data.mid(pos, sxrefPos - pos));
+    if (trailer.contains("/Prev") || trailer.contains("/XRefStm")) {
+        return fail(QObject::tr("Incrementally updated PDF is not supported."));
+    }
+
+    int rootNum = findReference(trailer, "Root");
+    if (rootNum == -1 || objs.isEmpty()) {
+        return fail(QObject::tr("Invalid PDF without catalog."));
+    }
+
+    // Each object ends before the next one or the table.
+    objs.insert(xrefPos, -1);
+    if (objs.lastKey() != xrefPos) {
+        return fail(QObject::tr("PDF with objects after cross-reference table is not supported."));
+    }
+
+    QVector<int> nums;
+    QVector<PdfObject> objects;
+    int maxNum = 0;
+    int pagesNum = -1;
+    for (auto it = objs.constBegin(); it.value() != -1; ++it) {
+        auto next = it + 1;
+        PdfObject obj;
+        if (!parseObject(p_data, it.key(), next.key(), it.value(), obj)) {
+            return fail(QObject::tr("Invalid object %1 in PDF.").arg(it.value()));
+        }
+
+        if (obj.m_text.contains(QRegExp("/Type\\s*/ObjStm\\b"))) {
+            return fail(QObject::tr("PDF with object stream is not supported."));
+        }
+
+        if (it.value() == rootNum) {
+            pagesNum = findReference(obj.m_text, "Pages");
+        }
+
+        nums.append(it.value());
+        objects.append(obj);
+        maxNum = qMax(maxNum, it.value());
+    }
+
+    if (pagesNum == -1) {
+        return fail(QObject::tr("Invalid PDF without pages."));
+    }
+
+    int delta = m_nextObj - 1;
+    for (int i = 0; i < objects.size(); ++i) {
+        // The catalog is replaced by the one of the target file.
+        if (nums[i] == rootNum) {
+            continue;
+        }
+
+        QString text = renumberReferences(objects[i].m_text, delta);
+        if (nums[i] == pagesNum) {
+            QRegExp countExp("/Count\\s+(\\d+)");
+            int idx = text.indexOf("<<");
+            if (idx == -1 || countExp.indexIn(text) == -1) {
+                return fail(QObject::tr("Invalid pages of PDF."));
+            }
+
+            text.insert(idx + 2, QString(" /Parent %1 0 R ").arg(c_pagesObj));
+            m_pageCount += countExp.cap(1).toInt();
+            m_kids.append(nums[i] + delta);
+        }
+
+        bool ret;
+        if (objects[i].m_streamStart == -1) {
+            ret = writeObject(nums[i] + delta, text.toLatin1());
+        } else {
+            QByteArray stream = QByteArray::fromRawData(p_data.constData() + objects[i].m_streamStart,
+                                                        objects[i].m_streamEnd - objects[i].m_streamStart);
+            ret = writeObject(nums[i] + delta, text.toLatin1(), &stream);
+        }
+
+        if (!ret) {
+            return false;
+        }
+    }
+
+    m_nextObj += maxNum;
+    return true;
+}
+
+bool VPdfMerger::finish()
+{
+    Q_ASSERT(m_file.isOpen());
+
+    if (m_kids.isEmpty()) {
+        return fail(QObject::tr("No page to write."));
+    }
+
+    QString kids;
+    for (auto kid : m_kids) {
+        kids += QString("%1 0 R ").arg(kid);
+    }
+
+    if (!writeObject(c_pagesObj,
+                     QString("\n<< /Type /Pages /Kids [ %1] /Count %2 >>\n").arg(kids)
+                                                                            .arg(m_pageCount)
+                                                                            .toLatin1())
+        || !writeObject(c_catalogObj,
+                        QString("\n<< /Type /Catalog /Pages %1 0 R >>\n").arg(c_pagesObj)
+                                                                         .toLatin1())) {
+        return false;
+    }
+
+    qint64 xrefPos = m_file.pos();
+    QByteArray xref = "xref\n0 " + QByteArray::number(m_offsets.size()) + "\n";
+    xref += "0000000000 65535 f \n";
+    for (int i = 1; i < m_offsets.size(); ++i) {
+        if (m_offsets[i] == -1) {
+            xref += "0000000000 00000 f \n";
+        } else {
+            xref += QString("%1 00000 n \n").arg(m_offsets[i], 10, 10, QChar('0')).toLatin1();
+        }
+    }
+
+    xref += QString("trailer\n<< /Size %1 /Root %2 0 R >>\nstartxref\n%3\n%%EOF\n").arg(m_offsets.size())
+                                                                                 .arg(c_catalogObj)
+                                                                                 .arg(xrefPos)
+                                                                                 .toLatin1();
+    if (m_file.write(xref) != xref.size()) {
+        return fail(QObject::tr("Fail to write file %1.").arg(m_file.fileName()));
+    }
+
+    m_file.close();
+    return true;
+}
+
+const QString &VPdfMerger::errorString() const
+{
+    return m_errMsg;
+}
+
+bool VPdfMerger::writeObject(int p_num, const QByteArray &p_text, const QByteArray *p_stream)
+{
+    while (m_offsets.size() <= p_num) {
+        m_offsets.append(-1);
+    }
+
+    m_offsets[p_num] = m_file.pos();
+
+    QByteArray data = QByteArray::number(p_num) + " 0 obj" + p_text;
+    if (p_stream) {
+        data += "stream\n";
+        if (m_file.write(data) != data.size()
+            || m_file.write(*p_stream) != p_stream->size()) {
+            return fail(QObject::tr("Fail to write file %1.").arg(m_file.fileName()));
+        }
+
+        data = "endstream";
+    }
+
+    data += "\nendobj\n";
+    if (m_file.write(data) != data.size()) {
+        return fail(QObject::tr("Fail to write file %1.").arg(m_file.fileName()));
+    }
+
+    return true;
+}
+
+bool VPdfMerger::fail(const QString &p_msg)
+{
+    qWarning() << "fail to merge PDF" << m_file.fileName() << p_msg;
+    m_errMsg = p_msg;
+    return false;
+}
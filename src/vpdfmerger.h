@@ -0,0 +1,61 @@
+#ifndef VPDFMERGER_H
+#define VPDFMERGER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QFile>
+#include <QVector>
+
+// Concatenate the pages of PDF documents into one PDF file.
+// Documents are written out as soon as they are appended, so only one of them
+// needs to be kept in memory. Only documents with a plain cross-reference table
+// and without object streams, like those printed by QWebEngine, are supported.
+// Document-level data such as outlines and named destinations are dropped.
+class VPdfMerger
+{
+public:
+    explicit VPdfMerger(const QString &p_filePath);
+
+    // Remove the target file if not finished.
+    ~VPdfMerger();
+
+    bool open();
+
+    // Append the pages of PDF document @p_data.
+    bool append(const QByteArray &p_data);
+
+    // Write the page tree and the cross-reference table.
+    bool finish();
+
+    const QString &errorString() const;
+
+private:
+    // Write object @p_num with text @p_text followed by stream data @p_stream
+    // if not NULL.
+    bool writeObject(int p_num, const QByteArray &p_text, const QByteArray *p_stream = NULL);
+
+    bool fail(const QString &p_msg);
+
+    QFile m_file;
+
+    // Object number -> offset in the file, or -1 for unused number.
+    QVector<qint64> m_offsets;
+
+    // First object number of the next appended document.
+    int m_nextObj;
+
+    // Object numbers of the page tree roots of the appended documents.
+    QVector<int> m_kids;
+
+    int m_pageCount;
+
+    QString m_errMsg;
+
+    // Object number of the catalog.
+    static const int c_catalogObj;
+
+    // Object number of the root of the page tree.
+    static const int c_pagesObj;
+};
+
+#endif // VPDFMERGER_H
@@ -1,14 +1,43 @@
 #include "vpreviewpage.h"
 
 #include <QDesktopServices>
+#include <QWebEngineProfile>
+#include <QCoreApplication>
+#include <QDir>
 
 #include "vmainwindow.h"
+#include "vconfigmanager.h"
 
 extern VMainWindow *g_mainWin;
 
-VPreviewPage::VPreviewPage(QWidget *parent) : QWebEnginePage(parent)
+extern VConfigManager *g_config;
+
+VPreviewPage::VPreviewPage(QWidget *parent)
+    : QWebEnginePage(sharedProfile(), parent)
+{
+
+}
+
+QWebEngineProfile *VPreviewPage::sharedProfile()
 {
+    static QWebEngineProfile *profile = NULL;
+    if (!profile) {
+        // A named profile is disk-based, so the HTTP cache of remote resources
+        // like MathJax from CDN and the local storage survive restarts.
+        // Scripts bundled in qrc, like markdown-it, highlight.js, mermaid and
+        // flowchart.js, bypass the HTTP cache and are still compiled by each
+        // page.
+        profile = new QWebEngineProfile(QStringLiteral("vnote_preview"),
+                                        QCoreApplication::instance());
+
+        QDir dir(g_config->getWebCacheFolder());
+        profile->setCachePath(dir.filePath("cache"));
+        profile->setPersistentStoragePath(dir.filePath("storage"));
+        profile->setHttpCacheType(QWebEngineProfile::DiskHttpCache);
+        profile->setPersistentCookiesPolicy(QWebEngineProfile::NoPersistentCookies);
+    }
 
+    return profile;
 }
 
 bool VPreviewPage::acceptNavigationRequest(const QUrl &p_url,
@@ -3,12 +3,18 @@
 
 #include <QWebEnginePage>
 
+class QWebEngineProfile;
+
 class VPreviewPage : public QWebEnginePage
 {
     Q_OBJECT
 public:
     explicit VPreviewPage(QWidget *parent = 0);
 
+    // The profile shared by all the preview pages, with a persistent HTTP
+    // cache for remote resources and persistent local storage.
+    static QWebEngineProfile *sharedProfile();
+
 protected:
     bool acceptNavigationRequest(const QUrl &p_url,
                                  NavigationType p_type,
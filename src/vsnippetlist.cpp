@@ -18,13 +18,23 @@ extern VMainWindow *g_mainWin;
 const QString VSnippetList::c_infoShortcutSequence = "F2";
 
 VSnippetList::VSnippetList(QWidget *p_parent)
-    : QWidget(p_parent)
+    : QWidget(p_parent),
+      m_initialized(false)
 {
     setupUI();
 
     initShortcuts();
 
     initActions();
+}
+
+void VSnippetList::initSnippets()
+{
+    if (m_initialized) {
+        return;
+    }
+
+    m_initialized = true;
 
     if (!readSnippetsFromConfig()) {
         VUtils::showMessage(QMessageBox::Warning,
@@ -614,10 +624,19 @@ bool VSnippetList::deleteSnippetFile(const VSnippet &p_snippet, QString *p_errMs
     return true;
 }
 
+void VSnippetList::showEvent(QShowEvent *p_event)
+{
+    initSnippets();
+
+    QWidget::showEvent(p_event);
+}
+
 void VSnippetList::focusInEvent(QFocusEvent *p_event)
 {
     QWidget::focusInEvent(p_event);
 
+    initSnippets();
+
     if (m_snippets.isEmpty()) {
         m_addBtn->setFocus();
     } else {
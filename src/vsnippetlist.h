@@ -15,6 +15,7 @@ class QLabel;
 class QAction;
 class QKeyEvent;
 class QFocusEvent;
+class QShowEvent;
 
 
 class VSnippetList : public QWidget, public VNavigationMode
@@ -23,9 +24,9 @@ class VSnippetList : public QWidget, public VNavigationMode
 public:
     explicit VSnippetList(QWidget *p_parent = nullptr);
 
-    const QVector<VSnippet> &getSnippets() const;
+    const QVector<VSnippet> &getSnippets();
 
-    const VSnippet *getSnippet(const QString &p_name) const;
+    const VSnippet *getSnippet(const QString &p_name);
 
     // Implementations for VNavigationMode.
     void showNavigation() Q_DECL_OVERRIDE;
@@ -36,6 +37,8 @@ protected:
 
     void focusInEvent(QFocusEvent *p_event) Q_DECL_OVERRIDE;
 
+    void showEvent(QShowEvent *p_event) Q_DECL_OVERRIDE;
+
 private slots:
     void newSnippet();
 
@@ -58,6 +61,9 @@ private:
 
     void makeSureFolderExist() const;
 
+    // Read snippets from config and fill the list on first use.
+    void initSnippets();
+
     // Update list of snippets according to m_snippets.
     void updateContent();
 
@@ -99,16 +105,21 @@ private:
 
     QVector<VSnippet> m_snippets;
 
+    // Whether snippets have been read from config.
+    bool m_initialized;
+
     static const QString c_infoShortcutSequence;
 };
 
-inline const QVector<VSnippet> &VSnippetList::getSnippets() const
+inline const QVector<VSnippet> &VSnippetList::getSnippets()
 {
+    initSnippets();
     return m_snippets;
 }
 
-inline const VSnippet *VSnippetList::getSnippet(const QString &p_name) const
+inline const VSnippet *VSnippetList::getSnippet(const QString &p_name)
 {
+    initSnippets();
     for (auto const & snip : m_snippets) {
         if (snip.getName() == p_name) {
             return &snip;
@@ -3,6 +3,7 @@
 
 #include <QXmlStreamReader>
 #include <QDebug>
+#include <algorithm>
 
 
 VTableOfContent::VTableOfContent()
@@ -22,6 +23,27 @@ void VTableOfContent::update(const VFile *p_file,
     m_file = p_file;
     m_table = p_table;
     m_type = p_type;
+
+    updateBlockIndex();
+}
+
+void VTableOfContent::updateBlockIndex()
+{
+    m_blockIndex.clear();
+    m_blockIndex.reserve(m_table.size());
+
+    int lastBlockNumber = -1;
+    for (int i = 0; i < m_table.size(); ++i) {
+        const VTableOfContentItem &item = m_table[i];
+        if (item.isEmpty() || item.m_blockNumber == -1) {
+            continue;
+        }
+
+        // Headers come in document order, so block numbers should be ascending.
+        Q_ASSERT(item.m_blockNumber >= lastBlockNumber);
+        lastBlockNumber = item.m_blockNumber;
+        m_blockIndex.append(i);
+    }
 }
 
 static bool parseTocUl(QXmlStreamReader &p_xml,
@@ -126,6 +148,7 @@ bool VTableOfContent::parseTableFromHtml(const QString &p_html)
 {
     bool ret = true;
     m_table.clear();
+    m_blockIndex.clear();
 
     if (!p_html.isEmpty()) {
         QXmlStreamReader xml(p_html);
@@ -172,14 +195,19 @@ int VTableOfContent::indexOfItemByBlockNumber(int p_blockNumber) const
         return -1;
     }
 
-    for (int i = m_table.size() - 1; i >= 0; --i) {
-        if (!m_table[i].isEmpty()
-            && m_table[i].m_blockNumber <= p_blockNumber) {
-            return i;
-        }
+    // Binary search for the first item whose block number is larger than
+    // @p_blockNumber. The one before it is what we want.
+    auto it = std::upper_bound(m_blockIndex.constBegin(),
+                               m_blockIndex.constEnd(),
+                               p_blockNumber,
+                               [this](int p_block, int p_idx) {
+                                   return p_block < m_table[p_idx].m_blockNumber;
+                               });
+    if (it == m_blockIndex.constBegin()) {
+        return -1;
     }
 
-    return -1;
+    return *(it - 1);
 }
 
 bool VTableOfContent::operator==(const VTableOfContent &p_outline) const
@@ -193,12 +193,19 @@ public:
     QString toString() const;
 
 private:
+    // Rebuild m_blockIndex from m_table.
+    void updateBlockIndex();
+
     // Corresponding file.
     const VFile *m_file;
 
     // Table of content.
     QVector<VTableOfContentItem> m_table;
 
+    // Indexes in @m_table of non-empty items with valid block number,
+    // sorted by block number to support binary search.
+    QVector<int> m_blockIndex;
+
     // Type of the table of content: by anchor or by block number.
     VTableOfContentType m_type;
 };
@@ -216,6 +223,7 @@ inline void VTableOfContent::setType(VTableOfContentType p_type)
 inline void VTableOfContent::clearTable()
 {
     m_table.clear();
+    m_blockIndex.clear();
 }
 
 inline const QVector<VTableOfContentItem> &VTableOfContent::getTable() const
@@ -226,12 +234,14 @@ inline const QVector<VTableOfContentItem> &VTableOfContent::getTable() const
 inline void VTableOfContent::setTable(const QVector<VTableOfContentItem> &p_table)
 {
     m_table = p_table;
+    updateBlockIndex();
 }
 
 inline void VTableOfContent::clear()
 {
     m_file = NULL;
     m_table.clear();
+    m_blockIndex.clear();
     m_type = VTableOfContentType::Anchor;
 }
 
@@ -231,40 +231,7 @@ void VWebView::hideUnusedActions(QMenu *p_menu)
 
 bool VWebView::removeStyles(QString &p_html)
 {
-    bool changed = false;
-
-    const QStringList &styles = g_config->getStylesToRemoveWhenCopied();
-    if (styles.isEmpty()) {
-        return changed;
-    }
-
-    QRegExp tagReg("(<[^>]+\\sstyle=[^>]*>)");
-
-    int pos = 0;
-    while (pos < p_html.size()) {
-        int idx = p_html.indexOf(tagReg, pos);
-        if (idx == -1) {
-            break;
-        }
-
-        QString styleStr = tagReg.cap(1);
-        QString alteredStyleStr = styleStr;
-
-        QString regPatt("(\\s|\")%1:[^;]+;");
-        for (auto const & sty : styles) {
-            QRegExp reg(regPatt.arg(sty));
-            alteredStyleStr.replace(reg, "\\1");
-        }
-
-        pos = idx + tagReg.matchedLength();
-        if (styleStr != alteredStyleStr) {
-            pos = pos + alteredStyleStr.size() - styleStr.size();
-            p_html.replace(idx, tagReg.matchedLength(), alteredStyleStr);
-            changed = true;
-        }
-    }
-
-    return changed;
+    return VWebUtils::removeStyles(p_html, g_config->getStylesToRemoveWhenCopied());
 }
 
 void VWebView::handleCopyWithoutBackgroundAction()
@@ -353,7 +320,7 @@ void VWebView::alterHtmlMimeData(QClipboard *p_clipboard,
     }
 
     // Set new mime data.
-    QMimeData *data = VClipboardUtils::cloneMimeData(p_mimeData);
+    QMimeData *data = VClipboardUtils::cloneMimeData(p_mimeData, QStringList("text/html"));
     data->setHtml(html);
 
     VClipboardUtils::setMimeDataToClipboard(p_clipboard, data, QClipboard::Clipboard);